@@ -0,0 +1,257 @@
+/*
+    bench_lex.c
+    lexes deterministic synthetic corpora for the example configs and reports the throughput
+
+    build: cc -O2 -o bench_lex bench/bench_lex.c
+    run:   ./bench_lex [-r repeats] [-c config] [size in MB ...] > results.jsonl
+
+    Without sizes every corpus is lexed at 1, 100 and 1024 MB.
+    Each run prints one JSON object per line to stdout, a readable summary goes to stderr.
+    The corpora only depend on the config and size, so results of different commits can be compared directly.
+    peak_rss_kb is the high-water mark of the process, runs are ordered by size so it belongs to the largest corpus so far.
+*/
+
+#include "../examples/examples.h"
+#include <time.h>
+#include <sys/resource.h>
+
+typedef struct{
+    const char *name;                      // one of example_targets
+    void (*record)(ExampleCorpus *corpus); // append one record of at most BENCH_RECORD_MAX bytes
+} BenchTarget;
+
+#define BENCH_RECORD_MAX 512
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static size_t bench_peak_rss_kb(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+static const char *bench_words[] = {
+    "the", "lexer", "reads", "a", "buffer", "and", "splits", "it", "into", "tokens", "every", "token", "has",
+    "type", "index", "location", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "configuration", "value"
+};
+
+static void bench_put_word(ExampleCorpus *corpus)
+{
+    example_put(corpus, bench_words[example_random(corpus, CLEKS_ARR_LEN(bench_words))]);
+}
+
+static void bench_put_number(ExampleCorpus *corpus)
+{
+    switch (example_random(corpus, 4)){
+        case 0: example_put_uint(corpus, example_random(corpus, 100000)); break;
+        case 1:
+            example_put(corpus, "-");
+            example_put_uint(corpus, example_random(corpus, 1000));
+            example_put(corpus, ".");
+            example_put_uint(corpus, example_random(corpus, 1000000));
+            break;
+        case 2:
+            example_put_uint(corpus, 1 + example_random(corpus, 9));
+            example_put(corpus, ".");
+            example_put_uint(corpus, example_random(corpus, 100));
+            example_put(corpus, "e-");
+            example_put_uint(corpus, example_random(corpus, 30));
+            break;
+        default:{
+            static const char hex[] = "0123456789abcdef";
+            example_put(corpus, "0x");
+            for (uint32_t i=0, n=2+example_random(corpus, 6); i<n; ++i) corpus->data[corpus->len++] = hex[example_random(corpus, 16)];
+        }
+    }
+}
+
+// an object of a JSON array, nested at most two levels deep
+static void bench_json_value(ExampleCorpus *corpus, int depth)
+{
+    uint32_t kind = example_random(corpus, (depth < 2)? 7 : 5);
+    switch (kind){
+        case 0: example_put(corpus, "true"); break;
+        case 1: example_put(corpus, "null"); break;
+        case 2: bench_put_number(corpus); break;
+        case 3:
+        case 4:
+            example_put(corpus, "\"");
+            bench_put_word(corpus);
+            example_put(corpus, " ");
+            bench_put_word(corpus);
+            example_put(corpus, "\"");
+            break;
+        case 5:
+            example_put(corpus, "[");
+            for (uint32_t i=0, n=example_random(corpus, 4); i<n; ++i){
+                if (i > 0) example_put(corpus, ", ");
+                bench_json_value(corpus, depth+1);
+            }
+            example_put(corpus, "]");
+            break;
+        default:
+            example_put(corpus, "{");
+            for (uint32_t i=0, n=example_random(corpus, 4); i<n; ++i){
+                example_put(corpus, (i > 0)? ", \"" : "\"");
+                bench_put_word(corpus);
+                example_put(corpus, "\": ");
+                bench_json_value(corpus, depth+1);
+            }
+            example_put(corpus, "}");
+    }
+}
+
+static void bench_json_record(ExampleCorpus *corpus)
+{
+    example_put(corpus, (corpus->len == 0)? "[\n  {\"id\": " : ",\n  {\"id\": ");
+    example_put_uint(corpus, example_random(corpus, 1000000));
+    example_put(corpus, ", \"");
+    bench_put_word(corpus);
+    example_put(corpus, "\": ");
+    bench_json_value(corpus, 0);
+    example_put(corpus, ", \"ok\": false}");
+}
+
+static void bench_html_record(ExampleCorpus *corpus)
+{
+    static const char *tags[] = {"div", "li", "ul", "span", "p", "a", "meta", "title"};
+    const char *tag = tags[example_random(corpus, CLEKS_ARR_LEN(tags))];
+    example_put(corpus, "<");
+    example_put(corpus, tag);
+    example_put(corpus, " class=\"c");
+    example_put_uint(corpus, example_random(corpus, 100));
+    example_put(corpus, "\">");
+    for (uint32_t i=0, n=1+example_random(corpus, 8); i<n; ++i){
+        example_put(corpus, " ");
+        bench_put_word(corpus);
+    }
+    if (example_random(corpus, 4) == 0) example_put(corpus, " <br>");
+    example_put(corpus, "</");
+    example_put(corpus, tag);
+    example_put(corpus, ">\n");
+}
+
+static void bench_config_record(ExampleCorpus *corpus)
+{
+    bench_put_word(corpus);
+    example_put(corpus, "_");
+    example_put_uint(corpus, example_random(corpus, 1000));
+    example_put(corpus, " = ");
+    switch (example_random(corpus, 3)){
+        case 0:
+            example_put(corpus, "\"");
+            bench_put_word(corpus);
+            example_put(corpus, " ");
+            bench_put_word(corpus);
+            example_put(corpus, "\"");
+            break;
+        case 1: bench_put_number(corpus); break;
+        default: bench_put_word(corpus);
+    }
+    example_put(corpus, "\n");
+}
+
+static void bench_txt_record(ExampleCorpus *corpus)
+{
+    static const char *ends[] = {".", "!", "?"};
+    for (uint32_t i=0, n=4+example_random(corpus, 12); i<n; ++i){
+        if (i > 0) example_put(corpus, (example_random(corpus, 8) == 0)? ", " : " ");
+        bench_put_word(corpus);
+    }
+    example_put(corpus, ends[example_random(corpus, CLEKS_ARR_LEN(ends))]);
+    example_put(corpus, (example_random(corpus, 6) == 0)? "\n" : " ");
+}
+
+// fill a corpus up to exactly `size` bytes, padding the end with spaces
+static bool bench_generate(ExampleCorpus *corpus, const BenchTarget *target, size_t size)
+{
+    if (!example_corpus(corpus, size, BENCH_RECORD_MAX, 0x9E3779B97F4A7C15ull)) return false;
+    bool json = target->record == bench_json_record;
+    size_t limit = (size > BENCH_RECORD_MAX)? size - BENCH_RECORD_MAX : 0;
+    while (corpus->len < limit) target->record(corpus);
+    if (json) example_put(corpus, (corpus->len == 0)? "[]" : "\n]");
+    cleks_assert(corpus->len <= size, "Corpus of %zu bytes is too small for a record", size);
+    memset(corpus->data + corpus->len, ' ', size - corpus->len);
+    corpus->len = size;
+    return true;
+}
+
+static double bench_lex(Clekser clekser, size_t *token_count)
+{
+    CleksToken token;
+    size_t count = 0;
+    double start = bench_now();
+    while (Cleks_next(&clekser, &token)) count++;
+    *token_count = count;
+    return bench_now() - start;
+}
+
+static void bench_run(const BenchTarget *target, size_t size_mb, int repeats)
+{
+    ExampleCorpus corpus;
+    if (!bench_generate(&corpus, target, size_mb*1024*1024)){
+        cleks_error("Could not allocate a corpus of %zu MB", size_mb);
+        return;
+    }
+    CleksCompiledConfig *compiled = Cleks_compile(example_find(target->name)->config);
+    cleks_assert(compiled != NULL, "Could not compile the config of %s", target->name);
+    size_t tokens = 0;
+    double best = 0;
+    for (int i=0; i<repeats; ++i){
+        double seconds = bench_lex(Cleks_create_compiled(corpus.data, corpus.len, compiled, NULL), &tokens);
+        if (i == 0 || seconds < best) best = seconds;
+    }
+    double mb = corpus.len / (1024.0*1024.0);
+    printf("{\"config\": \"%s\", \"size_mb\": %zu, \"bytes\": %zu, \"tokens\": %zu, \"seconds\": %.6f, \"mb_per_s\": %.2f, \"tokens_per_s\": %.0f, \"ns_per_token\": %.3f, \"peak_rss_kb\": %zu}\n",
+        target->name, size_mb, corpus.len, tokens, best, mb/best, tokens/best, best*1e9/tokens, bench_peak_rss_kb());
+    fflush(stdout);
+    fprintf(stderr, "%-14s %5zu MB: %9.2f MB/s %12.0f tokens/s %8.2f ns/token\n", target->name, size_mb, mb/best, tokens/best, best*1e9/tokens);
+    Cleks_compiled_free(compiled);
+    free(corpus.data);
+}
+
+int main(int argc, char **argv)
+{
+    BenchTarget targets[] = {
+        {"JsonConfig", bench_json_record},
+        {"html_config", bench_html_record},
+        {"config_config", bench_config_record},
+        {"txt_config", bench_txt_record},
+    };
+    size_t sizes[16] = {1, 100, 1024};
+    size_t size_count = 3;
+    int repeats = 3;
+    const char *only = NULL;
+    bool custom = false;
+    for (int i=1; i<argc; ++i){
+        if (strcmp(argv[i], "-r") == 0 && i+1 < argc) repeats = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-c") == 0 && i+1 < argc) only = argv[++i];
+        else if (atoi(argv[i]) > 0 && (!custom || size_count < CLEKS_ARR_LEN(sizes))){
+            if (!custom) size_count = 0;
+            custom = true;
+            sizes[size_count++] = atoi(argv[i]);
+        }
+        else{
+            fprintf(stderr, "usage: %s [-r repeats] [-c config] [size in MB ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repeats < 1) repeats = 1;
+    for (size_t s=0; s<size_count; ++s){
+        for (size_t t=0; t<CLEKS_ARR_LEN(targets); ++t){
+            if (only != NULL && strcmp(only, targets[t].name) != 0) continue;
+            bench_run(&targets[t], sizes[s], repeats);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*
+    bench_words.c
+    compares the word lookup of a plain Clekser with the hashed lookup of a compiled config
+
+    build: cc -O2 -o bench_words bench/bench_words.c
+    run:   ./bench_words
+*/
+
+#define CLEKS_IMPLEMENTATION
+#include "../cleks2.h"
+#include <time.h>
+
+#define BENCH_INPUT_WORDS 2000000
+
+CleksWhitespace bench_whitespaces[] = {' ', '\n'};
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+static double bench_lex(Clekser clekser, size_t *token_count)
+{
+    CleksToken token;
+    size_t count = 0;
+    double start = bench_now();
+    while (Cleks_next(&clekser, &token)) count++;
+    *token_count = count;
+    return bench_now() - start;
+}
+
+static void bench_run(size_t word_count)
+{
+    char (*names)[24] = malloc(word_count * sizeof(*names));
+    CleksWord *words = malloc(word_count * sizeof(*words));
+    for (size_t i=0; i<word_count; ++i){
+        snprintf(names[i], sizeof(names[i]), "kw%zu", i);
+        words[i] = names[i];
+    }
+    // every 4th word of the input is not a keyword
+    size_t buffer_size = BENCH_INPUT_WORDS * 16;
+    char *buffer = malloc(buffer_size);
+    size_t len = 0;
+    uint32_t seed = 42;
+    for (size_t i=0; i<BENCH_INPUT_WORDS; ++i){
+        seed = seed*1664525 + 1013904223;
+        size_t k = (seed >> 8) % word_count;
+        len += snprintf(buffer+len, buffer_size-len, (i%4 == 0)? "id%zu " : "kw%zu ", k);
+    }
+
+    CleksConfig config = {
+        .words = words,
+        .word_count = word_count,
+        .whitespaces = bench_whitespaces,
+        .whitespace_count = CLEKS_ARR_LEN(bench_whitespaces)
+    };
+    CleksCompiledConfig *compiled = Cleks_compile(&config);
+    size_t plain_tokens, compiled_tokens;
+    double plain = bench_lex(Cleks_create(buffer, len, &config, NULL), &plain_tokens);
+    double hashed = bench_lex(Cleks_create_compiled(buffer, len, compiled, NULL), &compiled_tokens);
+    cleks_assert(plain_tokens == compiled_tokens, "Token count mismatch: %zu != %zu", plain_tokens, compiled_tokens);
+    printf("%5zu words: loop %8.2f ns/token, hashed %8.2f ns/token (%.1fx)\n", word_count,
+        plain*1e9/plain_tokens, hashed*1e9/compiled_tokens, plain/hashed);
+
+    Cleks_compiled_free(compiled);
+    free(buffer);
+    free(words);
+    free(names);
+}
+
+int main(void)
+{
+    size_t sizes[] = {10, 100, 1000};
+    for (size_t i=0; i<CLEKS_ARR_LEN(sizes); ++i){
+        bench_run(sizes[i]);
+    }
+    return 0;
+}
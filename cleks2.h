@@ -26,6 +26,11 @@
 #ifndef _CLEKS_H
 #define _CLEKS_H
 
+// strict ISO C modes hide nanosleep, clock_gettime and the posix_madvise hints, this only helps if cleks2.h comes before any other system header
+#if defined(__STRICT_ANSI__) && !defined(__APPLE__) && !defined(_POSIX_C_SOURCE) && !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE) && !defined(_DEFAULT_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -34,6 +39,32 @@
 #include <string.h>
 #include <ctype.h>
 #include <assert.h>
+#include <math.h>
+#ifdef CLEKS_THREADS // define this to enable the functions lexing on multiple threads (requires pthreads)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if (defined(CLEKS_STATS) && defined(CLEKS_STATS_CYCLES)) || defined(CLEKS_THREADS)
+#include <time.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#define CLEKS__POSIX
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
 
 #define CLEKS_ARR_LEN(arr) (arr != NULL ? (sizeof((arr))/sizeof((arr)[0])) : 0) // get the length of an array
 #define CLEKS_ANSI_END "\e[0m" // reset ansi color
@@ -48,6 +79,8 @@
 #define CLEKS_FLAGS_BIN 0x8                // enable parsing of CLEKS_BIN
 #define CLEKS_FLAGS_KEEP_UNKNOWN 0x10      // do not mark CLEKS_UNKNOWN when printing using Cleks_print_default
 #define CLEKS_FLAGS_DISABLE_UNKNOWN 0x20   // do not allow CLEKS_UNKNOWN, throw error instead
+#define CLEKS_FLAGS_LONGEST_MATCH 0x40     // prefer the longest matching comment or field prefix over the first defined
+#define CLEKS_FLAGS_LAZY_LOC 0x80          // do not track rows and columns while lexing, resolve them using Cleks_loc_of
 
 /* Debugging */
 #define cleks_info(msg, ...) (printf("%s%s:%d: " msg CLEKS_ANSI_END "\n", CLEKS_ANSI_RGB(255, 255, 255), __FILE__, __LINE__, ## __VA_ARGS__))
@@ -59,14 +92,132 @@
 #define cleks_error(msg, ...) (fprintf(stderr, "%s%s:%d: [ERROR] " msg CLEKS_ANSI_END "\n", CLEKS_ANSI_RGB(255, 0, 0), __FILE__, __LINE__, ## __VA_ARGS__))
 
 #define cleks_assert(statement, msg, ...) do{if (!(statement)) {cleks_error(msg, ##__VA_ARGS__); exit(1);}} while (0);
+// internal consistency checks and argument validation of the public functions
+#ifdef CLEKS_RELEASE // define this to skip internal checks and report invalid arguments through CleksErrorFn instead of exiting
+#define CLEKS__PRIVATE static inline
+#define cleks__check(statement, msg, ...) ((void) 0)
+#define cleks__require(statement, result, msg, ...) do{if (!(statement)) {Cleks__report(NULL, CLEKS_ERROR_ARGUMENT, (CleksLoc) {0}, NULL, msg, ##__VA_ARGS__); return result;}} while (0)
+#else
+#define CLEKS__PRIVATE
+#define cleks__check(statement, msg, ...) cleks_assert(statement, msg, ##__VA_ARGS__)
+#define cleks__require(statement, result, msg, ...) cleks_assert(statement, msg, ##__VA_ARGS__)
+#endif
 
 /* Helper macros */
 #define clekser_inc(clekser) do{(clekser)->index++; (clekser)->loc.column++;}while(0);
 #define clekser__get_char(clekser) (clekser)->buffer[(clekser)->index]
 #define clekser__get_pointer(clekser) (clekser)->buffer + (clekser)->index
 #define clekser__check_line(clekser) do{if (clekser__get_char((clekser)) == '\n'){(clekser)->loc.row++; (clekser)->loc.column=1;}else{clekser->loc.column++;}}while(0);
+#define clekser__consume(clekser) do{if (((clekser)->config->flags & CLEKS_FLAGS_LAZY_LOC) == 0) clekser__check_line((clekser)); (clekser)->index++;}while(0);
 
 #define cleks__is_special(c) ((c) == '\0' || (c) == EOF)
+// an ASCII letter or digit, unlike isalnum independent of the locale
+#define cleks__is_alnum(c) ((uint8_t) ((c) - '0') < 10 || (uint8_t) (((c) | 0x20) - 'a') < 26)
+
+// hot path instrumentation, compiled to nothing without CLEKS_STATS
+#ifdef CLEKS_STATS
+#define clekser__stat_add(clekser, counter, n) ((clekser)->stats.counter += (n))
+#define clekser__stat_token(clekser, type) ((clekser)->stats.tokens[(type)]++)
+#else
+#define clekser__stat_add(clekser, counter, n) ((void) 0)
+#define clekser__stat_token(clekser, type) ((void) 0)
+#endif
+#if defined(CLEKS_STATS) && defined(CLEKS_STATS_CYCLES)
+#define clekser__phase_start(timer) uint64_t timer = Cleks__cycles()
+#define clekser__phase_end(clekser, phase, timer) ((clekser)->stats.cycles[(phase)] += Cleks__cycles() - (timer))
+#else
+#define clekser__phase_start(timer) ((void) 0)
+#define clekser__phase_end(clekser, phase, timer) ((void) 0)
+#endif
+
+// reference counts of shared configs, which may be dropped on different threads
+#if defined(__GNUC__)
+#define cleks__ref_inc(refs) __atomic_add_fetch((refs), 1, __ATOMIC_RELAXED)
+#define cleks__ref_dec(refs) __atomic_sub_fetch((refs), 1, __ATOMIC_ACQ_REL)
+#else
+#define cleks__ref_inc(refs) (++*(refs))
+#define cleks__ref_dec(refs) (--*(refs))
+#endif
+// the positions of a CleksPipeline, each written by one thread and read by the other
+#if defined(__GNUC__)
+#define cleks__load_acquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define cleks__store_release(p, value) __atomic_store_n((p), (value), __ATOMIC_RELEASE)
+#else
+// the positions are volatile, which only orders the accesses on strongly ordered targets
+#define cleks__load_acquire(p) (*(p))
+#define cleks__store_release(p, value) (*(p) = (value))
+#endif
+
+// per-byte character classes of a CleksCompiledConfig
+#define CLEKS__CLASS_WHITESPACE 0x01 // a CleksWhitespace
+#define CLEKS__CLASS_SYMBOL 0x02     // a CleksSymbol
+#define CLEKS__CLASS_STRING 0x04     // the start delimeter of a CleksString
+#define CLEKS__CLASS_COMMENT 0x08    // the first byte of a comment start delimeter
+#define CLEKS__CLASS_FIELD 0x10      // the first byte of a field prefix
+#define CLEKS__CLASS_SPECIAL 0x20    // '\0' or EOF
+// classes which always end an unknown word
+#define CLEKS__CLASS_WORD_END (CLEKS__CLASS_WHITESPACE | CLEKS__CLASS_SYMBOL | CLEKS__CLASS_STRING | CLEKS__CLASS_SPECIAL)
+
+// returned by the internal matching functions if nothing matched
+#define CLEKS__NO_MATCH 0xFFFFFFFF
+// how Cleks_destroy releases the buffer of a Clekser
+#define CLEKS__BUFFER_BORROWED 0  // owned by the caller
+#define CLEKS__BUFFER_MAPPED 1    // mapped by Cleks_create_from_file
+#define CLEKS__BUFFER_ALLOCATED 2 // read into memory by Cleks_create_from_file
+// identifies a token cache file, "CLEKSTC1" when read in little-endian byte order, so files of other byte orders never match
+#define CLEKS__CACHE_MAGIC 0x314354534B454C43ull
+// incremented whenever the layout of a token cache file or the meaning of its tokens changes
+#define CLEKS__CACHE_VERSION 2
+// set in the flags of a token cache file whose columns are uint64_t, for buffers of 4 GiB and more or token indices beyond CLEKS__CACHE_INDEX_MASK
+#define CLEKS__CACHE_WIDE 0x1
+// the bits of a token index a compact token cache file keeps below the type of each token
+#define CLEKS__CACHE_INDEX_BITS 28
+#define CLEKS__CACHE_INDEX_MASK ((1u << CLEKS__CACHE_INDEX_BITS) - 1)
+
+// the maximum number of distinct bytes Cleks__find_any searches for at once
+#define CLEKS__FIND_MAX 4
+// the maximum amount of 64 byte blocks the structural indexer classifies at once
+#define CLEKS__INDEX_BLOCKS 64
+// the size of a cache line, which the shared positions of a CleksPipeline are kept apart by
+#define CLEKS__CACHE_LINE 64
+// the amount of tokens after which either side of a CleksPipeline publishes its position, a power of 2
+#define CLEKS__PIPELINE_BATCH 64
+// the ring capacity of a CleksPipeline if none is given
+#define CLEKS__PIPELINE_CAPACITY 4096
+// the buffer size of a CleksWriter if none is given
+#define CLEKS__WRITER_CAPACITY (1 << 20)
+// the input a job of Cleks_lex_files covers at least, unless it reaches CLEKS__FILES_BATCH_MAX files first
+#define CLEKS__FILES_BATCH (64*1024)
+// the most files a job of Cleks_lex_files covers
+#define CLEKS__FILES_BATCH_MAX 64
+// the size of the chunks Cleks_lex_files splits large files into, files of at least twice the size are split
+#define CLEKS__FILES_CHUNK (1 << 20)
+// the first states of every CleksDfa
+#define CLEKS__DFA_END 0   // a word or prefix ends before the current byte
+#define CLEKS__DFA_START 1 // nothing of a word has been read yet
+// the accepted token of a word which is an error, as CLEKS_FLAGS_DISABLE_UNKNOWN is set
+#define CLEKS__DFA_REJECT cleks_token_id(CLEKS_TOKEN_TYPE_COUNT, 0)
+// the states of an automaton accepting the same literals as Cleks__scan_number, 0 rejects
+#define CLEKS__NUM_START 1
+#define CLEKS__NUM_SIGN 2
+#define CLEKS__NUM_ZERO 3
+#define CLEKS__NUM_INT 4
+#define CLEKS__NUM_DOT 5        // a '.' without integral digits
+#define CLEKS__NUM_FRACTION 6
+#define CLEKS__NUM_EXP 7
+#define CLEKS__NUM_EXP_SIGN 8
+#define CLEKS__NUM_EXP_DIGITS 9
+#define CLEKS__NUM_HEX_PREFIX 10
+#define CLEKS__NUM_HEX 11
+#define CLEKS__NUM_BIN_PREFIX 12
+#define CLEKS__NUM_BIN 13
+#define CLEKS__NUM_INF 14       // 14 + i: the first i+1 bytes of "infinity"
+#define CLEKS__NUM_NAN 22       // 22 + i: the first i+1 bytes of "nan"
+#define CLEKS__NUM_NAN_OPEN 25  // within the parentheses of "nan(...)"
+#define CLEKS__NUM_NAN_CLOSE 26
+#define CLEKS__NUM_COUNT 27
+// the amount of significant digits Cleks_token_to_double keeps exactly, more only decide the rounding
+#define CLEKS__DECIMAL_DIGITS 800
 
 /* User macros */
 // extract the CleksTokenType from the id of a token
@@ -84,6 +235,10 @@
 
 // used with cleks_token_id(type, index) if no index is supposed to be defined
 #define CLEKS_ANY_INDEX 0xFFFFFFFF
+// the symbol of a token whose lexeme was not interned
+#define CLEKS_NO_SYMBOL 0xFFFFFFFF
+// the amount of tokens a Clekser can hold for Cleks_peek
+#define CLEKS_PEEK_MAX 4
 
 /* Type definitions */
 typedef const char CleksSymbol;     // CLEKS_SYMBOL 
@@ -105,7 +260,7 @@ typedef enum{
 } CleksTokenType;
 
 // Printing names for each TokenType
-const char* CleksTokenTypeNames[] = {
+static const char* const CleksTokenTypeNames[] = {
 	[CLEKS_WORD] = "Word",
 	[CLEKS_SYMBOL] "Symbol",
 	[CLEKS_STRING] = "String",
@@ -119,6 +274,30 @@ const char* CleksTokenTypeNames[] = {
 
 _Static_assert(CLEKS_TOKEN_TYPE_COUNT == CLEKS_ARR_LEN(CleksTokenTypeNames), "CleksTokenTypeNames out of sync !");
 
+#ifdef CLEKS_STATS // define this to count where a Clekser spends its time, see Cleks_stats_dump
+// the parts of lexing a token timed with CLEKS_STATS_CYCLES
+typedef enum{
+	CLEKS_PHASE_TRIM,       // skipping whitespace
+	CLEKS_PHASE_COMMENTS,   // skipping comments between tokens
+	CLEKS_PHASE_STRINGS,    // lexing strings
+	CLEKS_PHASE_FIELDS,     // matching field prefixes and lexing fields
+	CLEKS_PHASE_WORDS,      // scanning for the end of a word
+	CLEKS_PHASE_CLASSIFY,   // sorting a word into words, numbers and unknowns
+	CLEKS_PHASE_COUNT       // not a phase, the amount of phases
+} CleksPhase;
+
+// counters collected by a Clekser while lexing
+typedef struct{
+	size_t whitespace_bytes;                 // bytes skipped as whitespace
+	size_t comment_bytes;                    // bytes inside comments, including the delimeters
+	size_t prefix_probes;                    // delimeter comparisons and prefix trie walks
+	size_t word_compares;                    // comparisons against configured words
+	size_t number_scans;                     // words tried as numbers
+	size_t tokens[CLEKS_TOKEN_TYPE_COUNT];   // tokens lexed of each type
+	uint64_t cycles[CLEKS_PHASE_COUNT];      // time spent in each phase, only measured with CLEKS_STATS_CYCLES
+} CleksStats;
+#endif
+
 // the original location of a token in the buffer
 typedef struct{
 	size_t row;
@@ -126,6 +305,29 @@ typedef struct{
 	char *filename;
 } CleksLoc;
 
+// the reason lexing failed
+typedef enum{
+	CLEKS_ERROR_NONE,                 // no error, e.g. the end of the buffer was reached
+	CLEKS_ERROR_ARGUMENT,             // a public function was called with invalid arguments
+	CLEKS_ERROR_MEMORY,               // an allocation failed
+	CLEKS_ERROR_IO,                   // a file could not be opened or read
+	CLEKS_ERROR_UNTERMINATED_STRING,  // a string is missing its end delimeter
+	CLEKS_ERROR_UNTERMINATED_COMMENT, // a comment is missing its end delimeter
+	CLEKS_ERROR_UNTERMINATED_FIELD,   // a field is missing its suffix
+	CLEKS_ERROR_UNKNOWN_WORD,         // an unknown word with CLEKS_FLAGS_DISABLE_UNKNOWN
+	CLEKS_ERROR_UNEXPECTED_TOKEN,     // Cleks_expect got a different token
+} CleksErrorKind;
+
+// an error reported by the lexer
+typedef struct{
+	CleksErrorKind kind;
+	CleksLoc loc;       // where the error occured, if it belongs to a buffer
+	size_t offset;      // the buffer offset of loc
+} CleksError;
+
+// receives every error instead of it being printed to stderr, `message` is only valid during the call
+typedef void (*CleksErrorFn) (void *user, CleksError error, const char *message);
+
 // the index of a token within a type config
 typedef uint32_t CleksTokenIndex;
 // a mask containing the CleksTokenType and CleksTokenIndex
@@ -137,6 +339,7 @@ typedef struct{
 	CleksLoc loc;    // the token's location in the buffer
 	char *start;     // pointer to the start of the token within the buffer
 	char *end;       // pointer to the end of the token within the buffer
+	uint32_t symbol; // the interned id of the lexeme, CLEKS_NO_SYMBOL if it was not interned
 } CleksToken;
 
 // a function used for printing a token representation
@@ -178,47 +381,478 @@ typedef struct{
     CleksPrintFn print_fn;
 } CleksConfig;
 
+// an immutable, precompiled form of a CleksConfig, created via Cleks_compile
+typedef struct{
+	CleksConfig config;                // the config the tables were built from
+	uint8_t classes[256];              // CLEKS__CLASS_* bitmask for each byte
+	CleksTokenIndex symbol_index[256]; // index into config.symbols for each byte
+	CleksTokenIndex string_index[256]; // index into config.strings for each start delimeter
+	uint16_t prefix_classes[256];      // byte -> column in prefix_next, 0 for bytes not used by any prefix
+	size_t prefix_alphabet_size;       // columns per node in prefix_next
+	uint32_t *prefix_next;             // trie of comment start delimeters and field prefixes, 0 is the dead state
+	CleksTokenIndex *prefix_comment;   // comment whose start delimeter ends at a node
+	CleksTokenIndex *prefix_field;     // field whose prefix ends at a node
+	uint32_t prefix_node_count;
+	size_t *comment_start_lens;        // strlen of each comment start delimeter
+	size_t *comment_end_lens;          // strlen of each comment end delimeter
+	size_t *field_prefix_lens;         // strlen of each field prefix
+	size_t *field_suffix_lens;         // strlen of each field suffix
+	size_t *word_lens;                 // strlen of each word
+	CleksTokenIndex *word_table;       // open addressing hash table of word indices
+	size_t word_table_mask;            // capacity of word_table - 1
+	bool indexable;                    // Cleks_tokenize_batch can use the structural indexer, see Cleks__index_tables
+	uint8_t index_low[16];             // low nibble -> index class bits of the bytes with that nibble
+	uint8_t index_high[16];            // high nibble -> index class bits assigned to that nibble
+	uint8_t index_whitespace;          // the index class bits of whitespace and special bytes
+	uint8_t index_symbol;              // the index class bits of symbols
+	uint8_t index_quote;               // the index class bit of the string delimeter
+	size_t refs;                       // owners of the tables, see Cleks_compiled_retain
+} CleksCompiledConfig;
+
+// a table-driven automaton of a whole CleksConfig, created via Cleks_compile_dfa
+typedef struct{
+	const CleksCompiledConfig *compiled; // the config the automaton was built from, which also scans strings and comments
+	uint8_t classes[256];                // byte -> column in next
+	uint32_t class_count;
+	uint32_t probe_class;                // bytes of this class and above may start a comment or field within a word
+	uint32_t state_count;
+	uint32_t prefix_start;               // the root of the comment and field prefix trie, word states come before it
+	uint16_t *next;                      // state*class_count + class -> state, CLEKS__DFA_END if the word or prefix ends
+	CleksTokenID *accept;                // the token of a word ending in each word state
+	CleksTokenIndex *prefix_comment;     // comment whose start delimeter ends at each state from prefix_start on
+	CleksTokenIndex *prefix_field;       // field whose prefix ends at each state from prefix_start on
+	size_t refs;                         // owners of the automaton, see Cleks_dfa_retain
+} CleksDfa;
+
+// a fixed block of interned lexemes
+typedef struct CleksArenaBlock{
+	struct CleksArenaBlock *next;
+	size_t used;
+	size_t capacity;
+	char data[];
+} CleksArenaBlock;
+
+// a table giving each distinct lexeme a dense id, the first one being 0
+typedef struct{
+	CleksArenaBlock *arena; // the lexemes, each terminated by '\0', they never move
+	const char **names;     // the lexeme of each id
+	size_t *lengths;        // the length of each lexeme
+	uint64_t *hashes;       // the hash of each lexeme
+	uint32_t count;
+	uint32_t capacity;
+	uint32_t *table;        // open addressing hash table of id+1, 0 marks an empty slot
+	size_t table_mask;      // capacity of table - 1
+	bool strings;           // also intern CLEKS_STRING tokens, not only CLEKS_UNKNOWN
+} CleksInterner;
+
 // the lexing structure containing runtime lexing information
 typedef struct{
 	char *buffer;
 	size_t buffer_size;
 	CleksLoc loc;
 	size_t index;
-	CleksConfig config;
+	const CleksConfig *config;           // shared with other lexers, never written
+	const CleksCompiledConfig *compiled; // optional lookup tables, NULL to walk the config directly
+	const CleksDfa *dfa;                 // optional automaton lexing instead of the lookup tables, see Cleks_use_dfa
+	size_t *line_starts;                 // offsets of every line start, built on demand by Cleks_loc_of
+	size_t line_count;
+	CleksInterner *interner;             // optional table assigning each token a symbol
+	CleksError error;                    // why the last token could not be lexed, CLEKS_ERROR_NONE at the end of the buffer
+	bool silent;                         // do not report lexing errors
+	uint8_t buffer_owner;                // CLEKS__BUFFER_*
+	uint8_t peek_start;                  // the ring position of the next token in `peeked`
+	uint8_t peek_count;                  // the amount of tokens lexed by Cleks_peek but not consumed yet
+	bool peek_failed;                    // lexing after the peeked tokens failed already
+	CleksToken *peeked;                  // ring of CLEKS_PEEK_MAX tokens, allocated by the first Cleks_peek
+#ifdef CLEKS_STATS
+	CleksStats stats;                    // what lexing has cost so far
+#endif
+#ifdef CLEKS_THREADS
+	struct CleksPipeline *pipeline;      // lexes on another thread while set, see Cleks_pipeline_start
+#endif
 } Clekser;
 
+// a growable struct-of-arrays collection of tokens
+typedef struct{
+	CleksTokenID *ids; // the type and index of each token
+	size_t *starts;    // the offset of each token's start within the buffer
+	size_t *lengths;   // the length of each token
+	size_t *rows;      // the row of each token's location
+	size_t *columns;   // the column of each token's location
+	uint32_t *symbols; // the interned symbol of each token
+	size_t count;
+	size_t capacity;
+} CleksTokenBuffer;
+
+// the header of a token cache file, followed by the ids, starts and lengths of every token and the line starts
+// every column is native uint32_t, with the type and index of each id packed into one, unless the file is CLEKS__CACHE_WIDE
+typedef struct{
+	uint64_t magic;        // CLEKS__CACHE_MAGIC
+	uint64_t version;      // CLEKS__CACHE_VERSION
+	uint64_t flags;        // CLEKS__CACHE_*
+	uint64_t config_hash;  // fingerprint of the config the tokens were lexed with
+	uint64_t content_hash; // hash of the lexed buffer
+	uint64_t content_size; // size of the lexed buffer
+	uint64_t token_count;
+	uint64_t line_count;
+	uint64_t payload_hash; // hash of everything after the header, to detect truncated or damaged files
+} CleksCacheHeader;
+
+// the tokens of a buffer loaded from a cache file, the columns point into the file and are read through Cleks_cache_token
+typedef struct{
+	const void *ids;             // the type and index of each token
+	const void *starts;          // the offset of each token's start within the buffer
+	const void *lengths;         // the length of each token
+	const void *line_starts;     // the offset of every line start within the buffer
+	size_t count;
+	size_t line_count;
+	bool wide;                   // the columns are uint64_t instead of uint32_t
+	void *data;                  // the contents of the cache file
+	size_t data_size;
+	uint8_t data_owner;          // CLEKS__BUFFER_*
+} CleksTokenCache;
+
+// an arbitrary precision decimal number, used for the rare numbers needing more than a double to round correctly
+typedef struct{
+	uint8_t digits[CLEKS__DECIMAL_DIGITS]; // digit values, most significant first
+	int count;                             // the amount of digits used
+	int point;                             // the position of the decimal point within the digits
+	bool truncated;                        // non-zero digits were dropped after the last one
+} CleksDecimal;
+
+// the structural indexer walking a buffer, which classifies whole blocks first and then yields the positions tokens start or end at
+typedef struct{
+	const CleksCompiledConfig *compiled;
+	const char *buffer;
+	size_t size;
+	size_t base;                          // the buffer offset of blocks[0]
+	size_t block;                         // the block currently walked
+	size_t block_count;                   // the blocks classified by the last fill
+	size_t window;                        // the blocks to classify by the next fill
+	uint64_t bits;                        // the positions of the current block not walked yet
+	uint64_t in_string;                   // all ones if the last classified byte was within a string
+	uint64_t after_word;                  // 1 if the last classified byte belonged to a word
+	uint64_t blocks[CLEKS__INDEX_BLOCKS]; // the structural positions of each block
+} CleksIndexer;
+
+// a replacement of `removed` bytes at `offset` by `inserted` new bytes
+typedef struct{
+	size_t offset;
+	size_t removed;
+	size_t inserted;
+} CleksEdit;
+
+// reads up to `size` bytes into `buffer`, returns the amount of bytes read or 0 at the end of the input
+typedef size_t (*CleksReadFn) (void *user, char *buffer, size_t size);
+
+// a lexer pulling its input through a CleksReadFn into a sliding window
+typedef struct{
+	Clekser clekser;               // lexes the window
+	CleksCompiledConfig *compiled;
+	CleksReadFn read_fn;
+	void *user;                    // passed to read_fn
+	char *window;
+	size_t window_capacity;
+	size_t offset;                 // the input offset of the first byte in the window
+	size_t lookahead;              // the maximum amount of bytes the lexer inspects at once
+	bool eof;                      // read_fn reached the end of the input
+	bool in_comment;               // the window ended inside a comment, whose scanned bytes were dropped already
+	CleksTokenIndex comment;       // the index into config.comments of that comment
+	CleksLoc comment_loc;          // where that comment started, for reporting it as unterminated
+} CleksStream;
+
+#ifdef CLEKS__POSIX
+// the output formats of a CleksWriter
+typedef enum{
+	CLEKS_FORMAT_TEXT,  // the lines of Cleks_print_default
+	CLEKS_FORMAT_TSV,   // file, row, column, type, index and value of each token separated by tabs, below a header line
+	CLEKS_FORMAT_JSONL, // one JSON object per line and token
+	CLEKS_FORMAT_COUNT  // not a format, the amount of formats
+} CleksFormat;
+
+// formats tokens into a buffer, which is written to a file descriptor whenever it is full
+typedef struct{
+	int fd;
+	CleksFormat format;
+	char *buffer;
+	size_t capacity;
+	size_t used;
+	bool failed;        // writing failed, everything after is dropped
+} CleksWriter;
+#endif
+
+#ifdef CLEKS_THREADS
+// a thread lexing ahead of a Clekser, handing it the tokens through a bounded single-producer single-consumer ring
+typedef struct CleksPipeline{
+	Clekser lexer;                           // lexes on the thread, a copy of the Clekser the pipeline was started for
+	Clekser *clekser;                        // pops the tokens
+	CleksToken *tokens;                      // the ring of lexed tokens
+	size_t *after;                           // the lexer index after each token of the ring
+	size_t mask;                             // the capacity of the ring - 1
+	pthread_t thread;
+	// only used by the consumer
+	size_t read;                             // the position of the next token to pop
+	size_t limit;                            // the tail the consumer saw last
+	CleksToken last;                         // the last popped token, which Cleks_pipeline_stop resumes after
+	size_t last_after;
+	bool ended;                              // the consumer got every token and the reason the lexer stopped
+	// shared, the positions only ever grow and wrap around the ring through `mask`
+	uint8_t padding_head[CLEKS__CACHE_LINE];
+	volatile size_t head;                    // the tokens before it were popped, so their slots may be reused
+	uint8_t padding_tail[CLEKS__CACHE_LINE];
+	volatile size_t tail;                    // the tokens before it were lexed
+	volatile bool done;                      // the lexer thread stopped, `lexer.error` tells why
+	volatile bool stop;                      // Cleks_pipeline_stop asks the lexer thread to end early
+} CleksPipeline;
+
+// called by Cleks_lex_files for every file it could read, on the thread that lexed it, so calls may overlap
+// `clekser` holds the buffer of the file and the `error` lexing stopped with, `tokens` every token before, return `false` to skip the remaining files
+typedef bool (*CleksFileFn)(void *user, size_t file, const Clekser *clekser, const CleksTokenBuffer *tokens);
+
+// the totals of a Cleks_lex_files run
+typedef struct{
+	size_t files;                            // the files lexed completely
+	size_t failed;                           // the files which could not be read or lexed completely
+	size_t bytes;                            // the size of every file read
+	size_t tokens;                           // the tokens of every file read
+	double seconds;                          // the wall-clock time of the whole run
+} CleksFilesStats;
+#endif
+
 /* Function declarations */
 
 // 'public' functions
-// initialization of a Clekser structure
-Clekser Cleks_create(char *buffer, size_t buffer_size, CleksConfig config, char *filename);
+// initialization of a Clekser structure, `config` has to outlive it
+Clekser Cleks_create(char *buffer, size_t buffer_size, const CleksConfig *config, char *filename);
+// initialization of a Clekser structure using precompiled lookup tables
+Clekser Cleks_create_compiled(char *buffer, size_t buffer_size, const CleksCompiledConfig *compiled, char *filename);
+// build the lookup tables for a config, returns NULL on allocation failure, the caller owns the first reference
+CleksCompiledConfig* Cleks_compile(const CleksConfig *config);
+// add an owner to a compiled config, which is freed once every owner called Cleks_compiled_free
+const CleksCompiledConfig* Cleks_compiled_retain(const CleksCompiledConfig *compiled);
+// drop a reference to a compiled config, freeing it with the last one
+void Cleks_compiled_free(const CleksCompiledConfig *compiled);
+// build a table-driven automaton lexing like `compiled`, which it keeps a reference to, returns NULL on failure
+CleksDfa* Cleks_compile_dfa(const CleksCompiledConfig *compiled);
+// add an owner to an automaton, which is freed once every owner called Cleks_dfa_free
+const CleksDfa* Cleks_dfa_retain(const CleksDfa *dfa);
+// drop a reference to an automaton, freeing it with the last one
+void Cleks_dfa_free(const CleksDfa *dfa);
+// lex using `dfa` from now on, or using its lookup tables again if `dfa` is NULL
+void Cleks_use_dfa(Clekser *clekser, const CleksDfa *dfa);
+// initialization of a Clekser structure lexing a whole file, which is memory-mapped where possible
+bool Cleks_create_from_file(Clekser *clekser, char *path, const CleksConfig *config);
+// free the memory a Clekser allocated while lexing, as well as the buffer of Cleks_create_from_file
+void Cleks_destroy(Clekser *clekser);
+// resolve the location of a buffer offset
+CleksLoc Cleks_loc_of(Clekser *clekser, size_t offset);
 // retreive the next token, returns `true` on success
 bool Cleks_next(Clekser *clekser, CleksToken *token);
-// retreive the next token and fail when not of specified type  
+// look at the token `n` places ahead without consuming it, 0 being the next one, `n` has to be less than CLEKS_PEEK_MAX
+bool Cleks_peek(Clekser *clekser, size_t n, CleksToken *token);
+// consume the next token, returns `false` where Cleks_next would
+bool Cleks_advance(Clekser *clekser);
+// append up to `max` tokens to a token buffer, returns the amount of tokens appended
+size_t Cleks_tokenize_batch(Clekser *clekser, CleksTokenBuffer *tokens, size_t max);
+// append all remaining tokens to a token buffer, returns `false` if memory ran out
+bool Cleks_tokenize_all(Clekser *clekser, CleksTokenBuffer *tokens);
+// rebuild the CleksToken at position `index` of a token buffer filled by `clekser`
+CleksToken Cleks_token_at(const Clekser *clekser, const CleksTokenBuffer *tokens, size_t index);
+// free the columns of a token buffer
+void Cleks_token_buffer_free(CleksTokenBuffer *tokens);
+// update the tokens of a buffer after an edit, `clekser` has to point to the edited buffer already
+bool Cleks_relex(Clekser *clekser, CleksTokenBuffer *tokens, CleksEdit edit);
+// write all tokens of the buffer of `clekser` to a cache file, replacing it atomically, returns `false` if lexing failed or has not reached the end of the buffer yet, or the file could not be written
+bool Cleks_cache_save(Clekser *clekser, const CleksTokenBuffer *tokens, const char *path);
+// map a cache file saved for the same config and buffer contents, returns `false` if there is none, so the buffer has to be lexed
+bool Cleks_cache_load(CleksTokenCache *cache, const char *path, const Clekser *clekser);
+// rebuild the CleksToken at position `index` of a loaded cache, its lexeme is never interned
+CleksToken Cleks_cache_token(const CleksTokenCache *cache, const Clekser *clekser, size_t index);
+// append all tokens of a loaded cache to a token buffer, returns `false` if memory ran out
+bool Cleks_cache_tokens(const CleksTokenCache *cache, const Clekser *clekser, CleksTokenBuffer *tokens);
+// unmap a loaded cache
+void Cleks_cache_free(CleksTokenCache *cache);
+// create an empty interner, attach it via `clekser.interner`, returns NULL on allocation failure
+CleksInterner* Cleks_interner_create(bool strings);
+// free an interner and all of its lexemes
+void Cleks_interner_free(CleksInterner *interner);
+// get the id of a lexeme, adding it if it is new, returns CLEKS_NO_SYMBOL if memory ran out
+uint32_t Cleks_intern(CleksInterner *interner, const char *str, size_t len);
+// the terminated lexeme of an id
+const char* Cleks_symbol_name(const CleksInterner *interner, uint32_t symbol);
+// initialization of a CleksStream, the window grows beyond `window_size` only for longer tokens
+bool Cleks_stream_create(CleksStream *stream, const CleksConfig *config, CleksReadFn read_fn, void *user, size_t window_size, char *filename);
+// retreive the next token of a stream, it is only valid until the next call
+bool Cleks_stream_next(CleksStream *stream, CleksToken *token);
+// the offset of a token within the whole input of a stream
+size_t Cleks_stream_offset(const CleksStream *stream, CleksToken token);
+// free the window and tables of a stream
+void Cleks_stream_destroy(CleksStream *stream);
+// a CleksReadFn reading from a FILE*
+size_t Cleks_read_file(void *file, char *buffer, size_t size);
+#ifdef CLEKS__POSIX
+// a CleksReadFn reading from a file descriptor, passed as `(void*) (intptr_t) fd`
+size_t Cleks_read_fd(void *fd, char *buffer, size_t size);
+#endif
+#ifdef CLEKS_THREADS
+// lex a whole buffer on `thread_count` threads, the tokens are identical to those of a serial Cleks_next loop
+// `error` (may be NULL) gets why lexing stopped, CLEKS_ERROR_NONE at the end of the buffer, returns `false` if lexing failed or memory ran out
+bool Cleks_tokenize_parallel(char *buffer, size_t buffer_size, const CleksConfig *config, size_t thread_count, CleksTokenBuffer *tokens, CleksError *error);
+// lex the rest of a buffer on a new thread, from which Cleks_next then takes the tokens through a ring of `capacity` tokens, 0 for a default
+bool Cleks_pipeline_start(CleksPipeline *pipeline, Clekser *clekser, size_t capacity);
+// end the lexer thread, the Clekser lexes on its own again, right after the last token it returned
+void Cleks_pipeline_stop(CleksPipeline *pipeline);
+// lex `path_count` files on `thread_count` threads, calling `callback` (may be NULL) with the tokens of each file, large files are split between threads
+// returns `false` if a file could not be read or lexed completely or a callback stopped the run, `stats` (may be NULL) gets the totals
+bool Cleks_lex_files(char **paths, size_t path_count, const CleksConfig *config, size_t thread_count, CleksFileFn callback, void *user, CleksFilesStats *stats);
+// print the totals and throughput of a Cleks_lex_files run
+void Cleks_files_stats_dump(const CleksFilesStats *stats, FILE *file);
+#endif
+// retreive the next token and fail when not of specified type, a token of a different type is consumed and reported as an error
 bool Cleks_expect(Clekser *clekser, CleksToken *token, CleksTokenID id);
-// extract the content of a token into seperate buffer
+// consume the next token only if it is of specified type, without reporting anything, to try alternatives
+bool Cleks_accept(Clekser *clekser, CleksToken *token, CleksTokenID id);
+// convert an integer, hex or bin token to a signed integer, returns `false` if it does not fit
+bool Cleks_token_to_i64(CleksToken token, int64_t *value);
+// convert an integer, hex or bin token to an unsigned integer, returns `false` if it does not fit
+bool Cleks_token_to_u64(CleksToken token, uint64_t *value);
+// convert a number token to the nearest double, independent of the locale
+bool Cleks_token_to_double(CleksToken token, double *value);
+// extract the content of a token into seperate buffer, decoding the escape sequences of strings
 bool Cleks_extract(CleksToken *token, char *buffer, size_t buffer_size);
+// decode escape sequences into a buffer, which is always terminated, returns the size needed including the '\0'
+size_t Cleks_unescape(const char *start, const char *end, char *buffer, size_t buffer_size);
+#ifdef CLEKS_STATS
+// print the counters of a Clekser
+void Cleks_stats_dump(const Clekser *clekser, FILE *file);
+// reset the counters of a Clekser
+void Cleks_stats_reset(Clekser *clekser);
+#endif
+// pass every error to `fn` instead of printing it, NULL to print again
+void Cleks_set_error_handler(CleksErrorFn fn, void *user);
 // use the print dialog associated with the Clekser to print a token
-void Cleks_print(Clekser clekser, CleksToken token);
+void Cleks_print(const Clekser *clekser, CleksToken token);
 // the default print dialog
-void Cleks_print_default(Clekser clekser, CleksToken token);
-
-// 'private' functions
-void Cleks__trim_left(Clekser *clekser);
-void Cleks__skip_string(Clekser *clekser, char *del);
-bool Cleks__try_skip_comments(Clekser *clekser, bool *result);
-bool Cleks__find_string(Clekser *clekser, char *del);
-bool Cleks__find_char(Clekser *clekser, char del);
-bool Cleks__try_find_string(Clekser *clekser, char *del);
-bool Cleks__try_find_char(Clekser *clekser, char del);
-void Cleks__set_token(CleksToken *token, uint32_t type, uint32_t id, CleksLoc loc, char *start, char *end);
-bool Cleks__is_symbol(Clekser *clekser, char symbol);
-bool Cleks__is_whitespace(Clekser *clekser, char c);
-bool Cleks__starts_with(Clekser *clekser, char *str);
-bool Cleks__str_is_float(char *s, char *e);
-bool Cleks__str_is_int(char *s, char *e);
-bool Cleks__str_is_hex(char *s, char *e);
-bool Cleks__str_is_bin(char *s, char *e);
+void Cleks_print_default(const Clekser *clekser, CleksToken token);
+#ifdef CLEKS__POSIX
+// initialization of a CleksWriter with a buffer of `capacity` bytes, 0 for a default, the caller keeps owning `fd`
+bool Cleks_writer_create(CleksWriter *writer, int fd, CleksFormat format, size_t capacity);
+// append a token in the format of the writer, returns `false` once writing failed
+bool Cleks_write_token(CleksWriter *writer, const Clekser *clekser, CleksToken token);
+// write everything buffered so far, returns `false` once writing failed
+bool Cleks_writer_flush(CleksWriter *writer);
+// flush and free the buffer of a writer, returns whether every token was written
+bool Cleks_writer_destroy(CleksWriter *writer);
+#endif
+
+// 'private' functions, only declared where they are defined when they are static
+#if !defined(CLEKS_RELEASE) || defined(CLEKS_IMPLEMENTATION)
+CLEKS__PRIVATE void Cleks__report(Clekser *clekser, CleksErrorKind kind, CleksLoc loc, const char *p, const char *format, ...);
+CLEKS__PRIVATE bool Cleks__next(Clekser *clekser, CleksToken *token);
+CLEKS__PRIVATE bool Cleks__lex(Clekser *clekser, CleksToken *token);
+CLEKS__PRIVATE bool Cleks__token_matches(CleksTokenID token, CleksTokenID id);
+CLEKS__PRIVATE bool Cleks__lex_string(Clekser *clekser, CleksToken *token, CleksTokenIndex index);
+CLEKS__PRIVATE bool Cleks__lex_field(Clekser *clekser, CleksToken *token, CleksTokenIndex index);
+CLEKS__PRIVATE bool Cleks__lex_dfa(Clekser *clekser, CleksToken *token);
+CLEKS__PRIVATE void Cleks__dfa_match_prefix(Clekser *clekser, size_t index, CleksTokenIndex *comment, CleksTokenIndex *field);
+CLEKS__PRIVATE CleksTokenID Cleks__dfa_accept(uint8_t flags, CleksTokenIndex word, CleksTokenType type);
+CLEKS__PRIVATE uint8_t Cleks__number_step(uint8_t state, uint8_t c);
+CLEKS__PRIVATE CleksTokenType Cleks__number_type(uint8_t state);
+CLEKS__PRIVATE bool Cleks__token_buffer_reserve(CleksTokenBuffer *tokens, size_t capacity);
+CLEKS__PRIVATE void Cleks__token_buffer_push(CleksTokenBuffer *tokens, const char *buffer, CleksToken token);
+CLEKS__PRIVATE bool Cleks__intern_token(Clekser *clekser, CleksToken *token);
+CLEKS__PRIVATE bool Cleks__interner_grow(CleksInterner *interner);
+CLEKS__PRIVATE bool Cleks__stream_fill(CleksStream *stream);
+CLEKS__PRIVATE bool Cleks__index_lines(Clekser *clekser);
+CLEKS__PRIVATE bool Cleks__cache_read(CleksTokenCache *cache, const char *path);
+CLEKS__PRIVATE size_t Cleks__cache_line(const CleksTokenCache *cache, size_t offset);
+CLEKS__PRIVATE size_t Cleks__cache_value(const void *column, bool wide, size_t index);
+CLEKS__PRIVATE CleksTokenID Cleks__cache_id(const CleksTokenCache *cache, size_t index);
+CLEKS__PRIVATE uint64_t Cleks__config_hash(const CleksConfig *config);
+CLEKS__PRIVATE size_t Cleks__lookahead(Clekser *clekser);
+CLEKS__PRIVATE size_t Cleks__token_extent(Clekser *clekser, CleksTokenID id, size_t start);
+CLEKS__PRIVATE CleksLoc Cleks__error_loc(Clekser *clekser, CleksLoc loc, char *p);
+CLEKS__PRIVATE void Cleks__trim_left(Clekser *clekser);
+CLEKS__PRIVATE void Cleks__index_tables(CleksCompiledConfig *compiled);
+CLEKS__PRIVATE size_t Cleks__tokenize_indexed(Clekser *clekser, CleksTokenBuffer *tokens, size_t max);
+CLEKS__PRIVATE void Cleks__index_fill(CleksIndexer *indexer);
+CLEKS__PRIVATE size_t Cleks__index_next(CleksIndexer *indexer);
+CLEKS__PRIVATE uint64_t Cleks__index_block(CleksIndexer *indexer, const char *block);
+CLEKS__PRIVATE void Cleks__index_classify(const CleksCompiledConfig *compiled, const char *block, uint64_t *whitespace, uint64_t *symbols, uint64_t *quotes);
+CLEKS__PRIVATE uint64_t Cleks__prefix_xor(uint64_t bits);
+CLEKS__PRIVATE unsigned Cleks__trailing_zeros(uint64_t bits);
+CLEKS__PRIVATE void Cleks__write(char *buffer, size_t space, size_t *written, const char *src, size_t len);
+#ifdef CLEKS__POSIX
+CLEKS__PRIVATE void Cleks__writer_put(CleksWriter *writer, const char *src, size_t len);
+CLEKS__PRIVATE void Cleks__writer_uint(CleksWriter *writer, size_t value);
+CLEKS__PRIVATE void Cleks__writer_escaped(CleksWriter *writer, const char *start, const char *end, bool json);
+#endif
+CLEKS__PRIVATE size_t Cleks__decode_escape(const char *p, const char *end, char *out, size_t *consumed);
+CLEKS__PRIVATE int32_t Cleks__hex_value(const char *p, const char *end, size_t digits);
+CLEKS__PRIVATE size_t Cleks__utf8_encode(uint32_t code_point, char *out);
+CLEKS__PRIVATE void Cleks__skip_string(Clekser *clekser, size_t len);
+CLEKS__PRIVATE bool Cleks__try_skip_comments(Clekser *clekser, bool *result);
+CLEKS__PRIVATE bool Cleks__skip_comment(Clekser *clekser, CleksTokenIndex index);
+CLEKS__PRIVATE bool Cleks__find_string(Clekser *clekser, char *del, size_t del_len);
+CLEKS__PRIVATE bool Cleks__find_char(Clekser *clekser, char del);
+CLEKS__PRIVATE bool Cleks__try_find_string(Clekser *clekser, char *del, size_t del_len);
+CLEKS__PRIVATE bool Cleks__try_find_char(Clekser *clekser, char del);
+CLEKS__PRIVATE size_t Cleks__stop_bytes(Clekser *clekser, char del, char *stops);
+CLEKS__PRIVATE size_t Cleks__find_any(const char *buffer, size_t index, size_t size, const char *bytes, size_t count);
+CLEKS__PRIVATE void Cleks__advance_to(Clekser *clekser, size_t index);
+CLEKS__PRIVATE void Cleks__set_token(CleksToken *token, uint32_t type, uint32_t id, CleksLoc loc, char *start, char *end);
+CLEKS__PRIVATE bool Cleks__classify_word(Clekser *clekser, CleksToken *token, CleksLoc loc, char *start, char *end);
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_word(Clekser *clekser, char *start, char *end);
+CLEKS__PRIVATE uint64_t Cleks__hash(const char *str, size_t len);
+CLEKS__PRIVATE uint64_t Cleks__content_hash(const void *data, size_t len, uint64_t seed);
+CLEKS__PRIVATE bool Cleks__is_symbol(Clekser *clekser, char symbol);
+CLEKS__PRIVATE bool Cleks__is_whitespace(Clekser *clekser, char c);
+CLEKS__PRIVATE bool Cleks__is_word_end(Clekser *clekser);
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_symbol(Clekser *clekser, char c);
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_string(Clekser *clekser, char c);
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_comment(Clekser *clekser);
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_field(Clekser *clekser);
+CLEKS__PRIVATE void Cleks__match_prefix(Clekser *clekser, CleksTokenIndex *comment, CleksTokenIndex *field);
+CLEKS__PRIVATE uint32_t Cleks__prefix_insert(CleksCompiledConfig *compiled, const char *str);
+CLEKS__PRIVATE bool Cleks__starts_with(Clekser *clekser, char *str);
+CLEKS__PRIVATE bool Cleks__starts_with_n(Clekser *clekser, char *str, size_t len);
+CLEKS__PRIVATE CleksTokenType Cleks__scan_number(const char *s, const char *e);
+CLEKS__PRIVATE bool Cleks__scan_special_float(const char *s, const char *e);
+CLEKS__PRIVATE bool Cleks__parse_u64(const char *s, const char *e, uint64_t *value);
+CLEKS__PRIVATE bool Cleks__is_eight_digits(const char *s);
+CLEKS__PRIVATE uint32_t Cleks__parse_eight_digits(const char *s);
+CLEKS__PRIVATE uint64_t Cleks__mul128(uint64_t a, uint64_t b, uint64_t *high);
+CLEKS__PRIVATE double Cleks__eisel_lemire(uint64_t mantissa, int64_t exponent);
+CLEKS__PRIVATE double Cleks__decimal_to_double(CleksDecimal *decimal, bool negative);
+CLEKS__PRIVATE void Cleks__decimal_shift_left(CleksDecimal *decimal, unsigned shift);
+CLEKS__PRIVATE void Cleks__decimal_shift_right(CleksDecimal *decimal, unsigned shift);
+CLEKS__PRIVATE void Cleks__decimal_shift(CleksDecimal *decimal, int shift);
+CLEKS__PRIVATE uint64_t Cleks__decimal_round(CleksDecimal *decimal);
+#if defined(CLEKS_STATS) && defined(CLEKS_STATS_CYCLES)
+CLEKS__PRIVATE uint64_t Cleks__cycles(void);
+#endif
+#ifdef CLEKS_THREADS
+// the bookkeeping of the parallel functions, defined along with them
+struct CleksChunk;
+struct CleksFilesEntry;
+struct CleksFilesRun;
+CLEKS__PRIVATE void Cleks__parallel_split(Clekser *clekser, struct CleksChunk *chunks, size_t chunk_count);
+CLEKS__PRIVATE bool Cleks__parallel_stitch(Clekser *clekser, struct CleksChunk *chunks, size_t chunk_count, CleksTokenBuffer *tokens);
+CLEKS__PRIVATE void Cleks__parallel_free(struct CleksChunk *chunks, size_t chunk_count);
+CLEKS__PRIVATE CleksLoc Cleks__loc_join(CleksLoc base, CleksLoc rel);
+CLEKS__PRIVATE void* Cleks__parallel_worker(void *arg);
+CLEKS__PRIVATE void* Cleks__pipeline_worker(void *arg);
+CLEKS__PRIVATE bool Cleks__pipeline_pop(Clekser *clekser, CleksToken *token);
+CLEKS__PRIVATE void Cleks__pipeline_wait(unsigned *spins);
+CLEKS__PRIVATE double Cleks__files_now(void);
+CLEKS__PRIVATE void* Cleks__files_worker(void *arg);
+CLEKS__PRIVATE bool Cleks__files_lex(struct CleksFilesRun *run, struct CleksFilesEntry *entry, CleksTokenBuffer *tokens, CleksFilesStats *stats);
+CLEKS__PRIVATE bool Cleks__files_chunk(struct CleksFilesRun *run, struct CleksFilesEntry *entry, size_t chunk, CleksTokenBuffer *tokens, CleksFilesStats *stats);
+CLEKS__PRIVATE bool Cleks__files_done(struct CleksFilesRun *run, struct CleksFilesEntry *entry, const Clekser *clekser, const CleksTokenBuffer *tokens, CleksFilesStats *stats);
+CLEKS__PRIVATE size_t Cleks__file_size(const char *path);
+CLEKS__PRIVATE int Cleks__files_compare(const void *a, const void *b);
+#endif
+#endif
 
 #endif // _CLEKS_H
 
@@ -227,394 +861,4076 @@ bool Cleks__str_is_bin(char *s, char *e);
 	define ClEKS_IMPLEMENTATION to gain access to the function implementations
 */
 
-#ifdef CLEKS_IMPLEMENTATION
+// the implementation is only compiled once per translation unit, even if several headers request it
+#if defined(CLEKS_IMPLEMENTATION) && !defined(_CLEKS_C)
+#define _CLEKS_C
 
-Clekser Cleks_create(char *buffer, size_t buffer_size, CleksConfig config, char *filename)
+Clekser Cleks_create(char *buffer, size_t buffer_size, const CleksConfig *config, char *filename)
 {
-	cleks_assert(buffer != NULL, "Invalid parameter buffer:%p", buffer);
-	return (Clekser) {.buffer = buffer, .buffer_size=buffer_size, .loc=(CleksLoc){1, 1, filename}, .index=0, .config=config};
+	cleks__require(buffer != NULL && config != NULL, (Clekser) {0}, "Invalid parameters buffer:%p, config:%p", buffer, config);
+	// lazy lexers leave every location at 0:0
+	size_t start = (config->flags & CLEKS_FLAGS_LAZY_LOC)? 0 : 1;
+	return (Clekser) {.buffer = buffer, .buffer_size=buffer_size, .loc=(CleksLoc){start, start, filename}, .index=0, .config=config, .compiled=NULL};
 }
 
-bool Cleks_next(Clekser *clekser, CleksToken *token)
+Clekser Cleks_create_compiled(char *buffer, size_t buffer_size, const CleksCompiledConfig *compiled, char *filename)
 {
-	cleks_assert(clekser != NULL && token != NULL, "Invalid arguments clekser:%p, token:%p", clekser, token);
+	cleks__require(buffer != NULL && compiled != NULL, (Clekser) {0}, "Invalid parameters buffer:%p, compiled:%p", buffer, compiled);
+	Clekser clekser = Cleks_create(buffer, buffer_size, &compiled->config, filename);
+	clekser.compiled = compiled;
+	return clekser;
+}
 
-	while (true){
-		if (clekser->index >= clekser->buffer_size) return false;
-		// skip spaces
-		Cleks__trim_left(clekser);
-		if (clekser->index >= clekser->buffer_size) return false;
-		// skip comments
-		bool comment_found = false;
-		if (!Cleks__try_skip_comments(clekser, &comment_found)) return false;
-		if (!comment_found) break;
+CleksCompiledConfig* Cleks_compile(const CleksConfig *config)
+{
+	cleks__require(config != NULL, NULL, "Invalid argument config:%p", config);
+	// every comment start delimeter and field prefix may add one trie node per byte
+	bool prefix_bytes[256] = {0};
+	size_t node_capacity = 1;
+	for (size_t i=0; i<config->comment_count; ++i){
+		for (const char *c = config->comments[i].start_del; *c; ++c, ++node_capacity) prefix_bytes[(uint8_t) *c] = true;
 	}
-	// zero-initialize the token
-	memset(token, 0, sizeof(*token));
-	// try to lex string
-	for (size_t i=0; i<clekser->config.string_count; ++i){
-		CleksString string = clekser->config.strings[i];
-		if (clekser__get_char(clekser) == string.start_del){
-			CleksLoc start_loc = clekser->loc;
-			clekser->index++;
-			clekser->loc.column++;
-			char *p_start = clekser__get_pointer(clekser);
-			if (!Cleks__try_find_char(clekser, string.end_del)){
-                cleks_error("Expected matching '%c' after string delimeter '%c' at %s:%d:%d", string.end_del, string.start_del, CLEKS_LOC_EXPAND(start_loc));
-                return false;
-            }
-			char *p_end = clekser__get_pointer(clekser);
-			Cleks__set_token(token, CLEKS_STRING, i, start_loc, p_start, p_end); 
-			clekser_inc(clekser);
-			return true;
-		}
+	for (size_t i=0; i<config->field_count; ++i){
+		for (const char *c = config->fields[i].prefix; *c; ++c, ++node_capacity) prefix_bytes[(uint8_t) *c] = true;
 	}
-	// try to lex symbols
-	for (size_t i=0; i<clekser->config.symbol_count; ++i){
-		if (clekser__get_char(clekser) == clekser->config.symbols[i]){
-			char *p_start = clekser__get_pointer(clekser);
-			Cleks__set_token(token, CLEKS_SYMBOL, i, clekser->loc, p_start, p_start+1);
-			clekser_inc(clekser);
-			return true;
-		}
+	size_t alphabet_size = 1;
+	for (size_t c=0; c<256; ++c) alphabet_size += prefix_bytes[c];
+	// keep the word table at most half full, so probe sequences stay short
+	size_t word_slots = 1;
+	while (word_slots < 2*config->word_count) word_slots <<= 1;
+	size_t size = sizeof(CleksCompiledConfig)
+		+ (2*config->comment_count + 2*config->field_count + config->word_count) * sizeof(size_t)
+		+ (node_capacity*alphabet_size) * sizeof(uint32_t)
+		+ (2*node_capacity + word_slots) * sizeof(CleksTokenIndex);
+	CleksCompiledConfig *compiled = calloc(1, size);
+	if (compiled == NULL) return NULL;
+	compiled->config = *config;
+	compiled->refs = 1;
+	compiled->comment_start_lens = (size_t*) (compiled + 1);
+	compiled->comment_end_lens = compiled->comment_start_lens + config->comment_count;
+	compiled->field_prefix_lens = compiled->comment_end_lens + config->comment_count;
+	compiled->field_suffix_lens = compiled->field_prefix_lens + config->field_count;
+	compiled->word_lens = compiled->field_suffix_lens + config->field_count;
+	compiled->prefix_next = (uint32_t*) (compiled->word_lens + config->word_count);
+	compiled->prefix_comment = compiled->prefix_next + node_capacity*alphabet_size;
+	compiled->prefix_field = compiled->prefix_comment + node_capacity;
+	compiled->word_table = compiled->prefix_field + node_capacity;
+	compiled->word_table_mask = word_slots - 1;
+	compiled->prefix_alphabet_size = alphabet_size;
+	compiled->prefix_node_count = 1;
+
+	for (size_t i=0; i<config->whitespace_count; ++i){
+		compiled->classes[(uint8_t) config->whitespaces[i]] |= CLEKS__CLASS_WHITESPACE;
 	}
-    
-    // lex fields
-    for (size_t i=0; i<clekser->config.field_count; ++i){
-        CleksField field = clekser->config.fields[i];
-        if (Cleks__starts_with(clekser, field.prefix)){
-            Cleks__skip_string(clekser, field.prefix);
-            char *p_start = clekser__get_pointer(clekser);
-            CleksLoc loc = clekser->loc;
-            if (!Cleks__try_find_string(clekser, field.suffix)){
-                cleks_error("Expected \"%s\" for matching field prefix \"%s\" at %s:%d:%d!", field.suffix, field.prefix, CLEKS_LOC_EXPAND(loc));
-                return false;
-            }
-            char *p_end = clekser__get_pointer(clekser);
-            Cleks__skip_string(clekser, field.suffix);
-            Cleks__set_token(token, CLEKS_FIELD, i, loc, p_start, p_end);
-            return true;
-        }
-    }
-    
-	char *p_start = clekser__get_pointer(clekser);
-	CleksLoc start_loc = clekser->loc;
-	char c;
-	while (true){
-		c = clekser__get_char(clekser);
-		if (Cleks__is_symbol(clekser, c) || Cleks__is_whitespace(clekser, c) || cleks__is_special(c)) break;
-		bool delimeter_found = false;
-		for (size_t i=0; i<clekser->config.string_count; ++i){
-			if (c == clekser->config.strings[i].start_del){
-				delimeter_found = true;
-				break;
-			}
-		}
-		if (delimeter_found) break;
-		for (size_t i=0; i<clekser->config.comment_count; ++i){
-			if (Cleks__starts_with(clekser, clekser->config.comments[i].start_del)){
-				delimeter_found = true;
-				break;
-			}
-		}
-		if (delimeter_found) break;
-        for (size_t i=0; i<clekser->config.field_count; ++i){
-            if (Cleks__starts_with(clekser, clekser->config.fields[i].prefix)){
-                delimeter_found = true;
-                break;
-            }
-        }
-        if (delimeter_found) break;
-		clekser_inc(clekser);
+	compiled->classes[(uint8_t) '\0'] |= CLEKS__CLASS_SPECIAL;
+	compiled->classes[(uint8_t) EOF] |= CLEKS__CLASS_SPECIAL;
+	// earlier definitions take precedence, just like when walking the config
+	for (size_t i=0; i<config->symbol_count; ++i){
+		uint8_t c = (uint8_t) config->symbols[i];
+		if (compiled->classes[c] & CLEKS__CLASS_SYMBOL) continue;
+		compiled->classes[c] |= CLEKS__CLASS_SYMBOL;
+		compiled->symbol_index[c] = i;
 	}
-	char *p_end = clekser__get_pointer(clekser);
-	for (size_t i=0; i<clekser->config.word_count; ++i){
-		if (memcmp(p_start, clekser->config.words[i], p_end-p_start) == 0){
-			Cleks__set_token(token, CLEKS_WORD, i, start_loc, p_start, p_end);
-			return true;
+	for (size_t i=0; i<config->string_count; ++i){
+		uint8_t c = (uint8_t) config->strings[i].start_del;
+		if (compiled->classes[c] & CLEKS__CLASS_STRING) continue;
+		compiled->classes[c] |= CLEKS__CLASS_STRING;
+		compiled->string_index[c] = i;
+	}
+
+	for (size_t c=0, column=1; c<256; ++c){
+		if (prefix_bytes[c]) compiled->prefix_classes[c] = column++;
+	}
+	for (size_t i=0; i<node_capacity; ++i){
+		compiled->prefix_comment[i] = CLEKS__NO_MATCH;
+		compiled->prefix_field[i] = CLEKS__NO_MATCH;
+	}
+	// an empty delimeter matches at every byte
+	for (size_t i=0; i<config->comment_count; ++i){
+		compiled->comment_start_lens[i] = strlen(config->comments[i].start_del);
+		compiled->comment_end_lens[i] = strlen(config->comments[i].end_del);
+		uint32_t node = Cleks__prefix_insert(compiled, config->comments[i].start_del);
+		if (compiled->prefix_comment[node] == CLEKS__NO_MATCH) compiled->prefix_comment[node] = i;
+		for (size_t c=0; c<256; ++c){
+			if (compiled->comment_start_lens[i] == 0 || (uint8_t) config->comments[i].start_del[0] == c) compiled->classes[c] |= CLEKS__CLASS_COMMENT;
 		}
 	}
-	// no matching words found
-	if ((clekser->config.flags & CLEKS_FLAGS_INTEGERS) && Cleks__str_is_int(p_start, p_end)){
-		Cleks__set_token(token, CLEKS_INTEGER, 0, start_loc, p_start, p_end);
-		return true;
+	for (size_t i=0; i<config->field_count; ++i){
+		compiled->field_prefix_lens[i] = strlen(config->fields[i].prefix);
+		compiled->field_suffix_lens[i] = strlen(config->fields[i].suffix);
+		uint32_t node = Cleks__prefix_insert(compiled, config->fields[i].prefix);
+		if (compiled->prefix_field[node] == CLEKS__NO_MATCH) compiled->prefix_field[node] = i;
+		for (size_t c=0; c<256; ++c){
+			if (compiled->field_prefix_lens[i] == 0 || (uint8_t) config->fields[i].prefix[0] == c) compiled->classes[c] |= CLEKS__CLASS_FIELD;
+		}
 	}
-	if ((clekser->config.flags & CLEKS_FLAGS_FLOATS)&& Cleks__str_is_float(p_start, p_end)){
-		Cleks__set_token(token, CLEKS_FLOAT, 0, start_loc, p_start, p_end);
-		return true;
+
+	for (size_t i=0; i<=compiled->word_table_mask; ++i){
+		compiled->word_table[i] = CLEKS__NO_MATCH;
 	}
-    if ((clekser->config.flags & CLEKS_FLAGS_HEX) && Cleks__str_is_hex(p_start, p_end)){
-        Cleks__set_token(token, CLEKS_HEX, 0, start_loc, p_start, p_end);
-        return true;
-    }
-    if ((clekser->config.flags & CLEKS_FLAGS_BIN) && Cleks__str_is_bin(p_start, p_end)){
-        Cleks__set_token(token, CLEKS_BIN, 0, start_loc, p_start, p_end);
-        return true;
-    }
-	if ((clekser->config.flags & CLEKS_FLAGS_DISABLE_UNKNOWN) == 0){
-		Cleks__set_token(token, CLEKS_UNKNOWN, (clekser->config.flags & CLEKS_FLAGS_KEEP_UNKNOWN)? 1:0, start_loc, p_start, p_end);
-		return true;
+	for (size_t i=0; i<config->word_count; ++i){
+		size_t len = compiled->word_lens[i] = strlen(config->words[i]);
+		size_t slot = Cleks__hash(config->words[i], len) & compiled->word_table_mask;
+		// duplicate words keep the index of their first definition
+		while (compiled->word_table[slot] != CLEKS__NO_MATCH && strcmp(config->words[compiled->word_table[slot]], config->words[i]) != 0){
+			slot = (slot + 1) & compiled->word_table_mask;
+		}
+		if (compiled->word_table[slot] == CLEKS__NO_MATCH) compiled->word_table[slot] = i;
 	}
-	cleks_error("Unknown word found (flags: %d) at %s:%d:%d \"%.*s\"\n", clekser->config.flags, start_loc.filename, start_loc.row, start_loc.column, p_end-p_start, p_start);
-	return false;
+	Cleks__index_tables(compiled);
+	return compiled;
 }
 
-bool Cleks_expect(Clekser *clekser, CleksToken *token, CleksTokenID id)
+const CleksCompiledConfig* Cleks_compiled_retain(const CleksCompiledConfig *compiled)
 {
-	CleksToken t_token;
-	if (!Cleks_next(clekser, &t_token)) return false;
-    CleksTokenType type = cleks_token_type(id);
-    CleksTokenIndex index = cleks_token_index(id);
-	if (cleks_token_type(t_token.id) != type || (index != CLEKS_ANY_INDEX && cleks_token_index(t_token.id) != index)){
-		cleks_error("Expected: %s:%d, but got %s:%d!", cleks_token_type_name(type), (index == CLEKS_ANY_INDEX ? 0 : index), cleks_token_type_name(cleks_token_type(t_token.id)), cleks_token_index(t_token.id));
-		return false;
-	}
-	memcpy(token, &t_token, sizeof(CleksToken));
-	return true;
+	cleks__require(compiled != NULL, NULL, "Invalid argument compiled:%p", compiled);
+	// the reference count is the only part of a compiled config ever written after Cleks_compile
+	cleks__ref_inc(&((CleksCompiledConfig*) compiled)->refs);
+	return compiled;
 }
 
-bool Cleks_extract(CleksToken *token, char *buffer, size_t buffer_size)
+void Cleks_compiled_free(const CleksCompiledConfig *compiled)
 {
-	if (token == NULL || buffer == NULL) return false;
-	size_t value_len = token->end - token->start;
-	if (value_len >= buffer_size) return false;
-	if (cleks_token_type(token->id) == CLEKS_STRING){
-		char temp_buffer[value_len+1];
-		memset(temp_buffer, 0, value_len+1);
-		char *pr = token->start;
-		char *pw = temp_buffer;
-		while (pr != token->end){
-			if (*pr == '\\'){
-				switch(*++pr){
-					case '\'': *pw = 0x27; break;
-					case '"':  *pw = 0x22; break;
-					case '?':  *pw = 0x3f; break;
-					case '\\': *pw = 0x5c; break;
-					case 'a':  *pw = 0x07; break;
-					case 'b':  *pw = 0x08; break;
-					case 'f':  *pw = 0x0c; break;
-					case 'n':  *pw = 0x0a; break;
-					case 'r':  *pw = 0x0d; break;
-					case 't':  *pw = 0x09; break;
-					case 'v':  *pw = 0x0b; break;
-					default:{
-						*pw++ = '\\';
-						*pw = *pr;
-					}
-				}
-			}
-			else{
-				*pw = *pr;
+	if (compiled == NULL || cleks__ref_dec(&((CleksCompiledConfig*) compiled)->refs) > 0) return;
+	free((void*) compiled);
+}
+
+CleksDfa* Cleks_compile_dfa(const CleksCompiledConfig *compiled)
+{
+	cleks__require(compiled != NULL, NULL, "Invalid argument compiled:%p", compiled);
+	CleksConfig config = compiled->config;
+	// a trie of the words over the bytes they use, like the one of the prefixes
+	uint16_t word_columns[256] = {0};
+	size_t word_alphabet = 1;
+	size_t node_capacity = 1;
+	for (size_t i=0; i<config.word_count; ++i){
+		for (const char *c = config.words[i]; *c; ++c, ++node_capacity){
+			if (word_columns[(uint8_t) *c] == 0) word_columns[(uint8_t) *c] = word_alphabet++;
+		}
+	}
+	// every trie node is reached by a single string, so it pairs with exactly one number state
+	size_t max_states = 2 + node_capacity + CLEKS__NUM_COUNT;
+	if (max_states + compiled->prefix_node_count > UINT16_MAX){
+		Cleks__report(NULL, CLEKS_ERROR_ARGUMENT, (CleksLoc) {0}, NULL, "The words of the config need more than %d states", UINT16_MAX);
+		return NULL;
+	}
+	size_t temp_size = (node_capacity*word_alphabet + 3*node_capacity + 2*max_states) * sizeof(uint32_t);
+	uint32_t *word_next = calloc(1, temp_size);
+	if (word_next == NULL) return NULL;
+	CleksTokenIndex *word_index = word_next + node_capacity*word_alphabet;
+	uint32_t *node_state = word_index + node_capacity;
+	uint32_t *state_node = node_state + node_capacity;
+	uint32_t *state_number = state_node + max_states;
+	for (size_t i=0; i<node_capacity; ++i) word_index[i] = CLEKS__NO_MATCH;
+	uint32_t node_count = 1;
+	for (size_t i=0; i<config.word_count; ++i){
+		uint32_t node = 0;
+		for (const char *c = config.words[i]; *c; ++c){
+			uint32_t *next = &word_next[node*word_alphabet + word_columns[(uint8_t) *c]];
+			if (*next == 0) *next = node_count++;
+			node = *next;
+		}
+		// duplicate words keep the index of their first definition
+		if (word_index[node] == CLEKS__NO_MATCH) word_index[node] = i;
+	}
+
+	// bytes behaving the same in every state share a column, those which may start a comment or field within a word come last
+	bool numbers = config.flags & CLEKS_FLAGS_ALL_NUMS;
+	uint8_t number_columns[256] = {0};
+	for (size_t c=0; c<256 && numbers; ++c){
+		number_columns[c] = c;
+		for (size_t other=0; other<c && number_columns[c] == c; ++other){
+			size_t state = 1;
+			while (state < CLEKS__NUM_COUNT && Cleks__number_step(state, c) == Cleks__number_step(state, other)) state++;
+			if (state == CLEKS__NUM_COUNT) number_columns[c] = number_columns[other];
+		}
+	}
+	uint8_t classes[256];
+	uint64_t signatures[256];
+	uint8_t representatives[256];
+	uint32_t class_count = 0;
+	uint32_t probe_class = 0;
+	for (int probing=0; probing<2; ++probing){
+		if (probing) probe_class = class_count;
+		for (size_t c=0; c<256; ++c){
+			uint8_t kind = compiled->classes[c];
+			bool end = kind & CLEKS__CLASS_WORD_END;
+			bool probe = !end && (kind & (CLEKS__CLASS_COMMENT | CLEKS__CLASS_FIELD));
+			if (probe != probing) continue;
+			uint64_t signature = end | (uint64_t) compiled->prefix_classes[c] << 1;
+			if (!end) signature |= (uint64_t) number_columns[c] << 17 | (uint64_t) word_columns[c] << 25;
+			uint32_t class = (probing)? probe_class : 0;
+			while (class < class_count && signatures[class] != signature) class++;
+			if (class == class_count){
+				signatures[class_count] = signature;
+				representatives[class_count++] = c;
 			}
-			pr++;   
-			pw++;
+			classes[c] = class;
 		}
-		snprintf(buffer, pw-temp_buffer+2, "%s", temp_buffer);
 	}
-	else{
-		sprintf(buffer, "%.*s", value_len, token->start);
+
+	size_t size = sizeof(CleksDfa)
+		+ max_states * sizeof(CleksTokenID)
+		+ 2*compiled->prefix_node_count * sizeof(CleksTokenIndex)
+		+ (max_states + compiled->prefix_node_count) * class_count * sizeof(uint16_t);
+	CleksDfa *dfa = calloc(1, size);
+	if (dfa == NULL){
+		free(word_next);
+		return NULL;
 	}
-	return true;
-}
+	dfa->compiled = Cleks_compiled_retain(compiled);
+	dfa->refs = 1;
+	memcpy(dfa->classes, classes, sizeof(classes));
+	dfa->class_count = class_count;
+	dfa->probe_class = probe_class;
+	dfa->accept = (CleksTokenID*) (dfa + 1);
+	dfa->prefix_comment = (CleksTokenIndex*) (dfa->accept + max_states);
+	dfa->prefix_field = dfa->prefix_comment + compiled->prefix_node_count;
+	uint16_t *next = (uint16_t*) (dfa->prefix_field + compiled->prefix_node_count);
 
-void Cleks_print_default(Clekser clekser, CleksToken token)
-{
-	// TODO: probably best to do this with string builders instead
-    if (token.loc.filename != NULL) printf("%s:", token.loc.filename);
-	CleksTokenType type = cleks_token_type(token.id);
-    CleksTokenIndex index = cleks_token_index(token.id);
-    bool keep_unknown = (type == CLEKS_UNKNOWN && index == 1);
-	printf("%d:%d %s: ", token.loc.row, token.loc.column, (keep_unknown)? "":cleks_token_type_name(type));
-	cleks_assert(type < CLEKS_TOKEN_TYPE_COUNT, "Invalid token type: %u!", type);
-	switch(type){
-		case CLEKS_WORD:
-		case CLEKS_SYMBOL: printf("'%.*s'", token.end-token.start, token.start); break;
-        case CLEKS_FIELD: printf("<%s '%.*s' %s>", clekser.config.fields[index].prefix, token.end-token.start, token.start, clekser.config.fields[index].suffix); break;
-		case CLEKS_STRING: printf("\"%.*s\"", token.end-token.start, token.start); break;
-		case CLEKS_INTEGER:
-		case CLEKS_FLOAT: 
-		case CLEKS_HEX: 
-		case CLEKS_BIN: printf("%.*s", token.end-token.start, token.start); break;
-		case CLEKS_UNKNOWN: {
-            if (keep_unknown){printf("%.*s", token.end-token.start, token.start);}
-            else {printf("`%.*s`", token.end-token.start, token.start);}
-        } break;
-		default: cleks_error("Uninplemented type in print: %s", cleks_token_type_name(type)); exit(1);
+	// walk all pairs of a trie node (node_count once the word can no longer match) and a number state reachable from the start
+	uint32_t dead_states[CLEKS__NUM_COUNT] = {0};
+	uint32_t state_count = 2;
+	state_node[CLEKS__DFA_START] = 0;
+	state_number[CLEKS__DFA_START] = (numbers)? CLEKS__NUM_START : 0;
+	node_state[0] = CLEKS__DFA_START;
+	for (uint32_t state=CLEKS__DFA_START; state<state_count; ++state){
+		uint32_t node = state_node[state];
+		for (uint32_t class=0; class<class_count; ++class){
+			uint8_t c = representatives[class];
+			if (compiled->classes[c] & CLEKS__CLASS_WORD_END) continue;
+			uint32_t next_node = (node < node_count)? word_next[node*word_alphabet + word_columns[c]] : 0;
+			uint32_t next_number = Cleks__number_step(state_number[state], c);
+			uint32_t *target = (next_node != 0)? &node_state[next_node] : &dead_states[next_number];
+			if (*target == 0){
+				state_node[state_count] = (next_node != 0)? next_node : node_count;
+				state_number[state_count] = next_number;
+				*target = state_count++;
+			}
+			next[state*class_count + class] = *target;
+		}
+		CleksTokenIndex word = (node < node_count)? word_index[node] : CLEKS__NO_MATCH;
+		dfa->accept[state] = Cleks__dfa_accept(config.flags, word, Cleks__number_type(state_number[state]));
 	}
-    putchar('\n');
+	free(word_next);
+
+	// the trie of comment start delimeters and field prefixes follows the word states
+	dfa->prefix_start = state_count;
+	dfa->state_count = state_count + compiled->prefix_node_count;
+	for (uint32_t node=0; node<compiled->prefix_node_count; ++node){
+		dfa->prefix_comment[node] = compiled->prefix_comment[node];
+		dfa->prefix_field[node] = compiled->prefix_field[node];
+		for (uint32_t class=0; class<class_count; ++class){
+			uint16_t column = compiled->prefix_classes[representatives[class]];
+			uint32_t child = (column != 0)? compiled->prefix_next[node*compiled->prefix_alphabet_size + column] : 0;
+			next[(state_count + node)*class_count + class] = (child != 0)? state_count + child : CLEKS__DFA_END;
+		}
+	}
+	dfa->next = next;
+	return dfa;
 }
 
-void Cleks_print(Clekser clekser, CleksToken token)
+const CleksDfa* Cleks_dfa_retain(const CleksDfa *dfa)
 {
-	if (clekser.config.print_fn != NULL){
-        clekser.config.print_fn(token);
-    }
-    else{
-        Cleks_print_default(clekser, token);
-    }
+	cleks__require(dfa != NULL, NULL, "Invalid argument dfa:%p", dfa);
+	cleks__ref_inc(&((CleksDfa*) dfa)->refs);
+	return dfa;
 }
 
-void Cleks__trim_left(Clekser *clekser)
+void Cleks_dfa_free(const CleksDfa *dfa)
 {
-	cleks_assert(clekser != NULL, "Invalid argument clekser:%p", clekser);
-	char c;
-	while (Cleks__is_whitespace(clekser, (c = clekser__get_char(clekser))) || cleks__is_special(c)){
-		clekser__check_line(clekser);
-		clekser->index++;
-	}
+	if (dfa == NULL || cleks__ref_dec(&((CleksDfa*) dfa)->refs) > 0) return;
+	Cleks_compiled_free(dfa->compiled);
+	free((void*) dfa);
 }
 
-void Cleks__skip_string(Clekser *clekser, char *str)
+void Cleks_use_dfa(Clekser *clekser, const CleksDfa *dfa)
 {
-	cleks_assert(clekser != NULL && str != NULL, "Invalid arguments clekser:%p, str:%p", clekser, str);
-	while (clekser__get_char(clekser) == *str++){
-		clekser__check_line(clekser);
-		clekser->index++;
-	}
+	cleks__require(clekser != NULL, , "Invalid argument clekser:%p", clekser);
+	clekser->dfa = dfa;
+	if (dfa == NULL) return;
+	clekser->compiled = dfa->compiled;
+	clekser->config = &dfa->compiled->config;
 }
 
-bool Cleks__find_string(Clekser *clekser, char *del)
+bool Cleks_create_from_file(Clekser *clekser, char *path, const CleksConfig *config)
 {
-	cleks_assert(clekser != NULL && del != NULL, "Invalid arguments clekser:%p, del:%p", clekser, del);
-	while (!Cleks__starts_with(clekser, del)){
-		if (clekser->index >= clekser->buffer_size) return false;
-		clekser__check_line(clekser);
-		clekser->index++;
+	cleks__require(clekser != NULL && path != NULL, false, "Invalid arguments clekser:%p, path:%p", clekser, path);
+	// empty files cannot be mapped, but still need a valid buffer
+	static char empty[1] = "";
+#ifdef CLEKS__POSIX
+	int fd = open(path, O_RDONLY);
+	if (fd < 0){
+		Cleks__report(NULL, CLEKS_ERROR_IO, (CleksLoc) {0}, NULL, "Could not open file '%s': %s", path, strerror(errno));
+		return false;
 	}
-    return true;
+	struct stat st;
+	if (fstat(fd, &st) != 0){
+		Cleks__report(NULL, CLEKS_ERROR_IO, (CleksLoc) {0}, NULL, "Could not stat file '%s': %s", path, strerror(errno));
+		close(fd);
+		return false;
+	}
+	size_t size = st.st_size;
+	char *buffer = empty;
+	if (size > 0){
+		buffer = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (buffer == MAP_FAILED){
+			Cleks__report(NULL, CLEKS_ERROR_IO, (CleksLoc) {0}, NULL, "Could not map file '%s': %s", path, strerror(errno));
+			close(fd);
+			return false;
+		}
+#ifdef POSIX_MADV_SEQUENTIAL
+		// only hints, strict ISO C modes do not declare them
+		posix_madvise(buffer, size, POSIX_MADV_SEQUENTIAL);
+		posix_madvise(buffer, size, POSIX_MADV_WILLNEED);
+#endif
+	}
+	close(fd);
+	*clekser = Cleks_create(buffer, size, config, path);
+	clekser->buffer_owner = (size > 0)? CLEKS__BUFFER_MAPPED : CLEKS__BUFFER_BORROWED;
+	return true;
+#else
+	FILE *file = fopen(path, "rb");
+	if (file == NULL){
+		Cleks__report(NULL, CLEKS_ERROR_IO, (CleksLoc) {0}, NULL, "Could not open file '%s'", path);
+		return false;
+	}
+	char *buffer = NULL;
+	long size = -1;
+	if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+	if (size > 0 && fseek(file, 0, SEEK_SET) == 0) buffer = malloc(size);
+	if (size > 0 && (buffer == NULL || fread(buffer, 1, size, file) != (size_t) size)){
+		Cleks__report(NULL, CLEKS_ERROR_IO, (CleksLoc) {0}, NULL, "Could not read file '%s'", path);
+		free(buffer);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+	if (size <= 0){
+		buffer = empty;
+		size = 0;
+	}
+	*clekser = Cleks_create(buffer, size, config, path);
+	clekser->buffer_owner = (size > 0)? CLEKS__BUFFER_ALLOCATED : CLEKS__BUFFER_BORROWED;
+	return true;
+#endif
 }
 
-bool Cleks__find_char(Clekser *clekser, char del)
+void Cleks_destroy(Clekser *clekser)
 {
-	cleks_assert(clekser != NULL, "Invalid argument clekser:%p", clekser);
-	while (clekser__get_char(clekser) != del){
-		if (clekser->index >= clekser->buffer_size) return false;
-		clekser__check_line(clekser);
-		clekser->index++;
+	if (clekser == NULL) return;
+	free(clekser->line_starts);
+	clekser->line_starts = NULL;
+	clekser->line_count = 0;
+	free(clekser->peeked);
+	clekser->peeked = NULL;
+	clekser->peek_count = 0;
+#ifdef CLEKS__POSIX
+	if (clekser->buffer_owner == CLEKS__BUFFER_MAPPED) munmap(clekser->buffer, clekser->buffer_size);
+#endif
+	if (clekser->buffer_owner == CLEKS__BUFFER_ALLOCATED) free(clekser->buffer);
+	if (clekser->buffer_owner != CLEKS__BUFFER_BORROWED){
+		clekser->buffer = NULL;
+		clekser->buffer_size = 0;
+		clekser->buffer_owner = CLEKS__BUFFER_BORROWED;
 	}
-    return true;
 }
 
-bool Cleks__try_find_string(Clekser *clekser, char *del)
+CleksLoc Cleks_loc_of(Clekser *clekser, size_t offset)
 {
-    cleks_assert(clekser != NULL && del != NULL, "Invalid argumens clekser:%p, del:%p", clekser, del);
-    while (!Cleks__starts_with(clekser, del)){
-        if (clekser->index >= clekser->buffer_size) return false;
-        bool comment_found = false;
-        if (!Cleks__try_skip_comments(clekser, &comment_found)) return false;
-        if (comment_found) continue;
-        clekser__check_line(clekser);
-        clekser->index++;
-    }
-    return true;
+	cleks__require(clekser != NULL && offset <= clekser->buffer_size, (CleksLoc) {0}, "Invalid arguments clekser:%p, offset:%zu", clekser, offset);
+	CleksLoc loc = {.filename = clekser->loc.filename};
+	if (clekser->line_starts == NULL && !Cleks__index_lines(clekser)){
+		// out of memory, count the lines directly
+		loc.row = 1;
+		size_t line_start = 0;
+		for (size_t i=0; i<offset; ++i){
+			if (clekser->buffer[i] != '\n') continue;
+			loc.row++;
+			line_start = i+1;
+		}
+		loc.column = offset - line_start + 1;
+		return loc;
+	}
+	// find the last line starting at or before offset
+	size_t low = 0, high = clekser->line_count;
+	while (high - low > 1){
+		size_t mid = low + (high - low)/2;
+		if (clekser->line_starts[mid] <= offset) low = mid;
+		else high = mid;
+	}
+	loc.row = low + 1;
+	loc.column = offset - clekser->line_starts[low] + 1;
+	return loc;
 }
 
-bool Cleks__try_find_char(Clekser *clekser, char del)
+bool Cleks_next(Clekser *clekser, CleksToken *token)
 {
-    cleks_assert(clekser != NULL, "Invalid arguments clekser:%p", clekser);
-    while (clekser__get_char(clekser) != del){
-        if (clekser->index >= clekser->buffer_size) return false;
-        bool comments_found = false;
-        if (!Cleks__try_skip_comments(clekser, &comments_found)) return false;
-        if (comments_found) continue;
-        clekser__check_line(clekser);
-        clekser->index++;
-    }
-    return true;
-}
-
-bool Cleks__try_skip_comments(Clekser *clekser, bool *result)
-{
-    for (size_t i=0; i<clekser->config.comment_count; ++i){
-        CleksComment comment = clekser->config.comments[i];
-        if (Cleks__starts_with(clekser, comment.start_del)){
-            CleksLoc loc = clekser->loc;
-            Cleks__skip_string(clekser, comment.start_del);
-            if (!Cleks__find_string(clekser, comment.end_del)){
-                cleks_error("Expected \"%s\" for matching comment delimeter \"%s\" at %s:%d:%d!", comment.end_del, comment.start_del, CLEKS_LOC_EXPAND(loc));
-                return false;
-            }
-            Cleks__skip_string(clekser, comment.end_del);
-            *result = true;
-            break;
-        }
-    }
-    return true;
+	cleks__require(clekser != NULL && token != NULL, false, "Invalid arguments clekser:%p, token:%p", clekser, token);
+	return Cleks__next(clekser, token);
 }
 
-void Cleks__set_token(CleksToken *token, uint32_t type, uint32_t index, CleksLoc loc, char *start, char *end)
+bool Cleks_peek(Clekser *clekser, size_t n, CleksToken *token)
 {
-	cleks_assert(token != NULL, "Invalid argument token:%p", token);
-	token->id = cleks_token_id(type, index);
-	token->loc = loc;
-	token->start = start;
-	token->end = end;
+	cleks__require(clekser != NULL && token != NULL && n < CLEKS_PEEK_MAX, false, "Invalid arguments clekser:%p, n:%zu, token:%p", clekser, n, token);
+	if (clekser->peeked == NULL){
+		clekser->peeked = malloc(CLEKS_PEEK_MAX * sizeof(*clekser->peeked));
+		if (clekser->peeked == NULL){
+			Cleks__report(clekser, CLEKS_ERROR_MEMORY, clekser->loc, NULL, "Could not allocate the peek ring");
+			return false;
+		}
+	}
+	while (clekser->peek_count <= n){
+		if (clekser->peek_failed) return false;
+		CleksToken *slot = &clekser->peeked[(clekser->peek_start + clekser->peek_count) % CLEKS_PEEK_MAX];
+		if (!Cleks__lex(clekser, slot)){
+			// keep the failure until Cleks_next reaches it, so it is reported only once
+			clekser->peek_failed = true;
+			return false;
+		}
+		clekser->peek_count++;
+	}
+	*token = clekser->peeked[(clekser->peek_start + n) % CLEKS_PEEK_MAX];
+	return true;
 }
 
-bool Cleks__is_whitespace(Clekser *clekser, char c)
+bool Cleks_advance(Clekser *clekser)
 {
-	cleks_assert(clekser != NULL, "Invalid argument clekser:%p", clekser);
-	for (size_t i=0; i<clekser->config.whitespace_count; ++i){
-		if (clekser->config.whitespaces[i] == c) return true;
-	}
-	return false;
+	cleks__require(clekser != NULL, false, "Invalid argument clekser:%p", clekser);
+	CleksToken token;
+	return Cleks__next(clekser, &token);
 }
 
-bool Cleks__is_symbol(Clekser *clekser, char c)
+size_t Cleks_tokenize_batch(Clekser *clekser, CleksTokenBuffer *tokens, size_t max)
 {
-	cleks_assert(clekser != NULL, "Invalid argument clekser:%p", clekser);
-	for (size_t i=0; i<clekser->config.symbol_count; ++i){
-		if (c == clekser->config.symbols[i]) return true;
+	cleks__require(clekser != NULL && tokens != NULL, 0, "Invalid arguments clekser:%p, tokens:%p", clekser, tokens);
+	const CleksCompiledConfig *compiled = clekser->compiled;
+	if (compiled != NULL && compiled->indexable && clekser->peek_count == 0 && !clekser->peek_failed) return Cleks__tokenize_indexed(clekser, tokens, max);
+	CleksToken token;
+	size_t appended = 0;
+	for (; appended < max; ++appended){
+		if (tokens->count == tokens->capacity && !Cleks__token_buffer_reserve(tokens, (tokens->capacity < 256)? 256 : 2*tokens->capacity)) break;
+		if (!Cleks__next(clekser, &token)) break;
+		Cleks__token_buffer_push(tokens, clekser->buffer, token);
 	}
-	return false;
+	return appended;
 }
 
-bool Cleks__starts_with(Clekser *clekser, char *str)
+bool Cleks_tokenize_all(Clekser *clekser, CleksTokenBuffer *tokens)
 {
-	cleks_assert(clekser != NULL, "Invalid arguments clekser:%p, str:%p", clekser, str);
-	char *curr = clekser->buffer + clekser->index;
-	for (size_t i=0, n=strlen(str); i<n; ++i, ++curr){
-		if (clekser->index + i >= clekser->buffer_size || *curr != *(str+i)) return false;
+	cleks__require(clekser != NULL && tokens != NULL, false, "Invalid arguments clekser:%p, tokens:%p", clekser, tokens);
+	// guess one token per 8 bytes to avoid most of the regrowing
+	size_t estimate = tokens->count + (clekser->buffer_size - clekser->index)/8;
+	if (estimate > tokens->capacity && !Cleks__token_buffer_reserve(tokens, estimate)) return false;
+	while (true){
+		if (tokens->count == tokens->capacity && !Cleks__token_buffer_reserve(tokens, (tokens->capacity < 256)? 256 : 2*tokens->capacity)) return false;
+		size_t space = tokens->capacity - tokens->count;
+		if (Cleks_tokenize_batch(clekser, tokens, space) < space) return true;
 	}
-	return true;
 }
 
-bool Cleks__str_is_int(char *s, char *e)
+CleksToken Cleks_token_at(const Clekser *clekser, const CleksTokenBuffer *tokens, size_t index)
 {
-	if (!s || !e || e-s < 1) return false;
-	if (*s == '-' || *s == '+') s++;
-	while (s < e){
-		if (!isdigit(*s++)) return false;
-	}
-	return true;
+	cleks__require(clekser != NULL && tokens != NULL && index < tokens->count, (CleksToken) {0}, "Invalid arguments clekser:%p, tokens:%p, index:%zu", clekser, tokens, index);
+	char *start = clekser->buffer + tokens->starts[index];
+	return (CleksToken) {
+		.id = tokens->ids[index],
+		.loc = (CleksLoc) {tokens->rows[index], tokens->columns[index], clekser->loc.filename},
+		.start = start,
+		.end = start + tokens->lengths[index],
+		.symbol = tokens->symbols[index]
+	};
 }
 
-bool Cleks__str_is_float(char *s, char *e)
+void Cleks_token_buffer_free(CleksTokenBuffer *tokens)
 {
-    char* ep = NULL;
-    strtod(s, &ep);
-    return (ep && ep == e);
+	if (tokens == NULL) return;
+	free(tokens->ids);
+	free(tokens->starts);
+	free(tokens->lengths);
+	free(tokens->rows);
+	free(tokens->columns);
+	free(tokens->symbols);
+	memset(tokens, 0, sizeof(*tokens));
 }
 
-bool Cleks__str_is_hex(char *s, char *e)
+bool Cleks_relex(Clekser *clekser, CleksTokenBuffer *tokens, CleksEdit edit)
 {
-	if (s == NULL || e == NULL || e-s < 3) return false;
-	if (*s++ != '0' || *s++ != 'x') return false;
-	while (s < e){
-		if (!isxdigit(*s++)) return false;
+	cleks__require(clekser != NULL && tokens != NULL, false, "Invalid arguments clekser:%p, tokens:%p", clekser, tokens);
+	cleks__require(edit.offset + edit.inserted <= clekser->buffer_size, false, "Edit of %zu bytes at %zu exceeds the buffer size %zu", edit.inserted, edit.offset, clekser->buffer_size);
+	// the line index and peeked tokens belong to the old buffer
+	clekser->peek_count = 0;
+	clekser->peek_failed = false;
+	free(clekser->line_starts);
+	clekser->line_starts = NULL;
+	clekser->line_count = 0;
+	bool lazy = (clekser->config->flags & CLEKS_FLAGS_LAZY_LOC) != 0;
+	// a token whose extent starts `lookahead` bytes before the edit was lexed without looking at it,
+	// so lexing can restart at the last such token, as whatever came before it is left untouched
+	size_t lookahead = Cleks__lookahead(clekser);
+	size_t low = 0, high = tokens->count;
+	while (low < high){
+		size_t mid = low + (high - low)/2;
+		if (Cleks__token_extent(clekser, tokens->ids[mid], tokens->starts[mid]) + lookahead <= edit.offset) low = mid+1;
+		else high = mid;
+	}
+	size_t first = 0;
+	size_t start = lazy? 0 : 1;
+	CleksLoc loc = {start, start, clekser->loc.filename};
+	size_t restart = 0;
+	if (low > 0){
+		first = low - 1;
+		restart = Cleks__token_extent(clekser, tokens->ids[first], tokens->starts[first]);
+		loc.row = tokens->rows[first];
+		loc.column = tokens->columns[first];
+		// a field is located after its prefix, step back to the start of it
+		size_t located = tokens->starts[first];
+		if (!lazy && cleks_token_type(tokens->ids[first]) == CLEKS_FIELD){
+			size_t newlines = 0;
+			for (size_t i=restart; i<located; ++i) newlines += clekser->buffer[i] == '\n';
+			if (newlines == 0) loc.column -= located - restart;
+			else{
+				size_t line_start = restart;
+				while (line_start > 0 && clekser->buffer[line_start-1] != '\n') line_start--;
+				loc.row -= newlines;
+				loc.column = restart - line_start + 1;
+			}
+		}
+	}
+	clekser->index = restart;
+	clekser->loc = loc;
+	// relex until a token starts at the same place of the unchanged tail as an old one
+	CleksTokenBuffer fresh = {0};
+	CleksToken token;
+	size_t old = first;
+	bool synced = false;
+	while (Cleks__lex(clekser, &token)){
+		size_t offset = token.start - clekser->buffer;
+		size_t extent = Cleks__token_extent(clekser, token.id, offset);
+		if (extent >= edit.offset + edit.inserted){
+			while (old < tokens->count && Cleks__token_extent(clekser, tokens->ids[old], tokens->starts[old]) + edit.inserted < extent + edit.removed) old++;
+			if (old < tokens->count && Cleks__token_extent(clekser, tokens->ids[old], tokens->starts[old]) + edit.inserted == extent + edit.removed){
+				synced = true;
+				break;
+			}
+		}
+		if (fresh.count == fresh.capacity && !Cleks__token_buffer_reserve(&fresh, (fresh.capacity < 64)? 64 : 2*fresh.capacity)){
+			Cleks_token_buffer_free(&fresh);
+			return false;
+		}
+		Cleks__token_buffer_push(&fresh, clekser->buffer, token);
+	}
+	size_t tail = synced? tokens->count - old : 0;
+	size_t count = first + fresh.count + tail;
+	if (count > tokens->capacity && !Cleks__token_buffer_reserve(tokens, count)){
+		Cleks_token_buffer_free(&fresh);
+		return false;
+	}
+	if (synced){
+		size_t to = first + fresh.count;
+		if (to != old){
+			memmove(tokens->ids + to, tokens->ids + old, tail * sizeof(*tokens->ids));
+			size_t *columns[] = {tokens->starts, tokens->lengths, tokens->rows, tokens->columns};
+			for (size_t c=0; c<CLEKS_ARR_LEN(columns); ++c) memmove(columns[c] + to, columns[c] + old, tail * sizeof(size_t));
+			memmove(tokens->symbols + to, tokens->symbols + old, tail * sizeof(*tokens->symbols));
+		}
+		// only the tokens on the line of the first unchanged one move horizontally
+		size_t old_row = tokens->rows[to], old_column = tokens->columns[to];
+		for (size_t i=to; i<count && tokens->rows[i] == old_row; ++i) tokens->columns[i] = tokens->columns[i] - old_column + token.loc.column;
+		if (old_row != token.loc.row){
+			for (size_t i=to; i<count; ++i) tokens->rows[i] = tokens->rows[i] - old_row + token.loc.row;
+		}
+		if (edit.inserted != edit.removed){
+			for (size_t i=to; i<count; ++i) tokens->starts[i] = tokens->starts[i] + edit.inserted - edit.removed;
+		}
+	}
+	if (fresh.count > 0){
+		memcpy(tokens->ids + first, fresh.ids, fresh.count * sizeof(*tokens->ids));
+		memcpy(tokens->starts + first, fresh.starts, fresh.count * sizeof(size_t));
+		memcpy(tokens->lengths + first, fresh.lengths, fresh.count * sizeof(size_t));
+		memcpy(tokens->rows + first, fresh.rows, fresh.count * sizeof(size_t));
+		memcpy(tokens->columns + first, fresh.columns, fresh.count * sizeof(size_t));
+		memcpy(tokens->symbols + first, fresh.symbols, fresh.count * sizeof(*fresh.symbols));
 	}
+	tokens->count = count;
+	Cleks_token_buffer_free(&fresh);
 	return true;
 }
 
-bool Cleks__str_is_bin(char *s, char *e)
+bool Cleks_cache_save(Clekser *clekser, const CleksTokenBuffer *tokens, const char *path)
 {
-	if (s == NULL || e == NULL || e-s < 3) return false;
-	if (*s++ != '0' || *s++ != 'b') return false;
-	while (s < e){
-		char c = *s++;
-		if (c != '0' && c != '1') return false;
+	cleks__require(clekser != NULL && tokens != NULL && path != NULL, false, "Invalid arguments clekser:%p, tokens:%p, path:%p", clekser, tokens, path);
+	// the tokens before an error must not replace lexing, which would report it
+	if (clekser->error.kind != CLEKS_ERROR_NONE) return false;
+	// only the tokens of the whole buffer may stand in for lexing it, not those of a partial batch or with tokens left in the peek ring
+	if (clekser->index < clekser->buffer_size || clekser->peek_count > 0) return false;
+	if (clekser->line_starts == NULL && !Cleks__index_lines(clekser)){
+		Cleks__report(NULL, CLEKS_ERROR_MEMORY, (CleksLoc) {0}, NULL, "Could not index the lines for token cache '%s'", path);
+		return false;
 	}
-	return true;
+	size_t count = tokens->count, lines = clekser->line_count;
+	// the columns only need uint64_t for huge buffers or ids which cannot be packed into 32 bits
+	bool wide = (uint64_t) clekser->buffer_size > UINT32_MAX;
+	for (size_t i=0; i<count && !wide; ++i) wide = cleks_token_index(tokens->ids[i]) > CLEKS__CACHE_INDEX_MASK || cleks_token_type(tokens->ids[i]) >= (1u << (32 - CLEKS__CACHE_INDEX_BITS));
+	size_t width = wide? sizeof(uint64_t) : sizeof(uint32_t);
+	size_t payload_size = (3*count + lines) * width;
+	size_t path_len = strlen(path);
+	CleksCacheHeader *header = malloc(sizeof(*header) + payload_size);
+	char *temp = malloc(path_len + sizeof(".tmp"));
+	if (header == NULL || temp == NULL){
+		Cleks__report(NULL, CLEKS_ERROR_MEMORY, (CleksLoc) {0}, NULL, "Could not allocate %zu bytes for token cache '%s'", sizeof(*header) + payload_size, path);
+		free(header);
+		free(temp);
+		return false;
+	}
+	void *payload = header + 1;
+	if (wide){
+		uint64_t *column = payload;
+		for (size_t i=0; i<count; ++i) *column++ = tokens->ids[i];
+		for (size_t i=0; i<count; ++i) *column++ = tokens->starts[i];
+		for (size_t i=0; i<count; ++i) *column++ = tokens->lengths[i];
+		for (size_t i=0; i<lines; ++i) *column++ = clekser->line_starts[i];
+	}
+	else{
+		uint32_t *column = payload;
+		for (size_t i=0; i<count; ++i) *column++ = (uint32_t) cleks_token_type(tokens->ids[i]) << CLEKS__CACHE_INDEX_BITS | cleks_token_index(tokens->ids[i]);
+		for (size_t i=0; i<count; ++i) *column++ = (uint32_t) tokens->starts[i];
+		for (size_t i=0; i<count; ++i) *column++ = (uint32_t) tokens->lengths[i];
+		for (size_t i=0; i<lines; ++i) *column++ = (uint32_t) clekser->line_starts[i];
+	}
+	*header = (CleksCacheHeader) {
+		.magic = CLEKS__CACHE_MAGIC,
+		.version = CLEKS__CACHE_VERSION,
+		.flags = wide? CLEKS__CACHE_WIDE : 0,
+		.config_hash = Cleks__config_hash(clekser->config),
+		.content_hash = Cleks__content_hash(clekser->buffer, clekser->buffer_size, 0),
+		.content_size = clekser->buffer_size,
+		.token_count = count,
+		.line_count = lines,
+		.payload_hash = Cleks__content_hash(payload, payload_size, 0)
+	};
+	// write next to the destination first, so a reader never sees a partial file
+	memcpy(temp, path, path_len);
+	memcpy(temp + path_len, ".tmp", sizeof(".tmp"));
+	FILE *file = fopen(temp, "wb");
+	bool written = file != NULL && fwrite(header, 1, sizeof(*header) + payload_size, file) == sizeof(*header) + payload_size;
+	if (file != NULL && fclose(file) != 0) written = false;
+	if (written && rename(temp, path) != 0){
+		// rename does not replace existing files everywhere
+		remove(path);
+		written = rename(temp, path) == 0;
+	}
+	if (!written){
+		Cleks__report(NULL, CLEKS_ERROR_IO, (CleksLoc) {0}, NULL, "Could not write token cache '%s'", path);
+		remove(temp);
+	}
+	free(header);
+	free(temp);
+	return written;
+}
+
+bool Cleks_cache_load(CleksTokenCache *cache, const char *path, const Clekser *clekser)
+{
+	cleks__require(cache != NULL && path != NULL && clekser != NULL, false, "Invalid arguments cache:%p, path:%p, clekser:%p", cache, path, clekser);
+	memset(cache, 0, sizeof(*cache));
+	if (!Cleks__cache_read(cache, path)) return false;
+	const CleksCacheHeader *header = cache->data;
+	const char *payload = (const char*) (header + 1);
+	size_t payload_size = cache->data_size - sizeof(*header);
+	bool wide = cache->data_size >= sizeof(*header) && (header->flags & CLEKS__CACHE_WIDE);
+	size_t width = wide? sizeof(uint64_t) : sizeof(uint32_t);
+	size_t words = payload_size / width;
+	// the cheap checks first, hashing the whole buffer is left for last
+	bool valid = cache->data_size >= sizeof(*header) && payload_size % width == 0
+		&& header->magic == CLEKS__CACHE_MAGIC && header->version == CLEKS__CACHE_VERSION
+		&& (header->flags & ~(uint64_t) CLEKS__CACHE_WIDE) == 0
+		&& header->content_size == clekser->buffer_size && (wide || header->content_size <= UINT32_MAX)
+		&& header->token_count <= words/3 && header->line_count == words - 3*header->token_count
+		&& header->config_hash == Cleks__config_hash(clekser->config)
+		&& header->payload_hash == Cleks__content_hash(payload, payload_size, 0)
+		&& header->content_hash == Cleks__content_hash(clekser->buffer, clekser->buffer_size, 0);
+	if (!valid){
+		Cleks_cache_free(cache);
+		return false;
+	}
+	cache->count = header->token_count;
+	cache->line_count = header->line_count;
+	cache->wide = wide;
+	cache->ids = payload;
+	cache->starts = payload + cache->count*width;
+	cache->lengths = payload + 2*cache->count*width;
+	cache->line_starts = payload + 3*cache->count*width;
+	return true;
+}
+
+CleksToken Cleks_cache_token(const CleksTokenCache *cache, const Clekser *clekser, size_t index)
+{
+	cleks__require(cache != NULL && clekser != NULL && index < cache->count, (CleksToken) {0}, "Invalid arguments cache:%p, clekser:%p, index:%zu", cache, clekser, index);
+	size_t offset = Cleks__cache_value(cache->starts, cache->wide, index);
+	CleksTokenID id = Cleks__cache_id(cache, index);
+	// lazy lexers leave every location at 0:0, the others locate strings at their start delimeter
+	CleksLoc loc = {.filename = clekser->loc.filename};
+	if ((clekser->config->flags & CLEKS_FLAGS_LAZY_LOC) == 0){
+		size_t at = offset - (cleks_token_type(id) == CLEKS_STRING);
+		size_t line = Cleks__cache_line(cache, at);
+		loc.row = line + 1;
+		loc.column = at - Cleks__cache_value(cache->line_starts, cache->wide, line) + 1;
+	}
+	return (CleksToken) {
+		.id = id,
+		.loc = loc,
+		.start = clekser->buffer + offset,
+		.end = clekser->buffer + offset + Cleks__cache_value(cache->lengths, cache->wide, index),
+		.symbol = CLEKS_NO_SYMBOL
+	};
+}
+
+bool Cleks_cache_tokens(const CleksTokenCache *cache, const Clekser *clekser, CleksTokenBuffer *tokens)
+{
+	cleks__require(cache != NULL && clekser != NULL && tokens != NULL, false, "Invalid arguments cache:%p, clekser:%p, tokens:%p", cache, clekser, tokens);
+	if (!Cleks__token_buffer_reserve(tokens, tokens->count + cache->count)) return false;
+	bool lazy = (clekser->config->flags & CLEKS_FLAGS_LAZY_LOC) != 0;
+	size_t line = 0;
+	for (size_t i=0; i<cache->count; ++i){
+		size_t t = tokens->count++;
+		size_t offset = Cleks__cache_value(cache->starts, cache->wide, i);
+		CleksTokenID id = Cleks__cache_id(cache, i);
+		size_t at = offset - (cleks_token_type(id) == CLEKS_STRING);
+		// the tokens are in order, so the lines only move forward
+		while (line+1 < cache->line_count && Cleks__cache_value(cache->line_starts, cache->wide, line+1) <= at) line++;
+		tokens->ids[t] = id;
+		tokens->starts[t] = offset;
+		tokens->lengths[t] = Cleks__cache_value(cache->lengths, cache->wide, i);
+		tokens->rows[t] = lazy? 0 : line + 1;
+		tokens->columns[t] = lazy? 0 : at - Cleks__cache_value(cache->line_starts, cache->wide, line) + 1;
+		tokens->symbols[t] = CLEKS_NO_SYMBOL;
+	}
+	return true;
+}
+
+void Cleks_cache_free(CleksTokenCache *cache)
+{
+	if (cache == NULL) return;
+#ifdef CLEKS__POSIX
+	if (cache->data_owner == CLEKS__BUFFER_MAPPED) munmap(cache->data, cache->data_size);
+#endif
+	if (cache->data_owner == CLEKS__BUFFER_ALLOCATED) free(cache->data);
+	memset(cache, 0, sizeof(*cache));
+}
+
+CleksInterner* Cleks_interner_create(bool strings)
+{
+	CleksInterner *interner = calloc(1, sizeof(*interner));
+	if (interner == NULL) return NULL;
+	interner->strings = strings;
+	if (!Cleks__interner_grow(interner)){
+		Cleks_interner_free(interner);
+		return NULL;
+	}
+	return interner;
+}
+
+void Cleks_interner_free(CleksInterner *interner)
+{
+	if (interner == NULL) return;
+	while (interner->arena != NULL){
+		CleksArenaBlock *next = interner->arena->next;
+		free(interner->arena);
+		interner->arena = next;
+	}
+	free(interner->names);
+	free(interner->lengths);
+	free(interner->hashes);
+	free(interner->table);
+	free(interner);
+}
+
+uint32_t Cleks_intern(CleksInterner *interner, const char *str, size_t len)
+{
+	cleks__require(interner != NULL && str != NULL, CLEKS_NO_SYMBOL, "Invalid arguments interner:%p, str:%p", interner, str);
+	uint64_t hash = Cleks__hash(str, len);
+	size_t slot = hash & interner->table_mask;
+	for (; interner->table[slot] != 0; slot = (slot + 1) & interner->table_mask){
+		uint32_t symbol = interner->table[slot] - 1;
+		if (interner->hashes[symbol] == hash && interner->lengths[symbol] == len && memcmp(interner->names[symbol], str, len) == 0) return symbol;
+	}
+	// the table has twice the capacity, so it stays at most half full
+	if (interner->count == interner->capacity){
+		if (!Cleks__interner_grow(interner)) return CLEKS_NO_SYMBOL;
+		for (slot = hash & interner->table_mask; interner->table[slot] != 0; slot = (slot + 1) & interner->table_mask);
+	}
+	CleksArenaBlock *block = interner->arena;
+	if (block == NULL || block->capacity - block->used < len + 1){
+		size_t capacity = (len + 1 > 64*1024)? len + 1 : 64*1024;
+		block = malloc(sizeof(*block) + capacity);
+		if (block == NULL) return CLEKS_NO_SYMBOL;
+		block->next = interner->arena;
+		block->used = 0;
+		block->capacity = capacity;
+		interner->arena = block;
+	}
+	char *name = block->data + block->used;
+	memcpy(name, str, len);
+	name[len] = '\0';
+	block->used += len + 1;
+	uint32_t symbol = interner->count++;
+	interner->names[symbol] = name;
+	interner->lengths[symbol] = len;
+	interner->hashes[symbol] = hash;
+	interner->table[slot] = symbol + 1;
+	return symbol;
+}
+
+const char* Cleks_symbol_name(const CleksInterner *interner, uint32_t symbol)
+{
+	cleks__require(interner != NULL && symbol < interner->count, NULL, "Invalid arguments interner:%p, symbol:%u", interner, symbol);
+	return interner->names[symbol];
+}
+
+// give a token its symbol, if the clekser interns tokens of its type
+CLEKS__PRIVATE bool Cleks__intern_token(Clekser *clekser, CleksToken *token)
+{
+	CleksInterner *interner = clekser->interner;
+	if (interner == NULL) return true;
+	CleksTokenType type = cleks_token_type(token->id);
+	if (type != CLEKS_UNKNOWN && (type != CLEKS_STRING || !interner->strings)) return true;
+	token->symbol = Cleks_intern(interner, token->start, token->end - token->start);
+	if (token->symbol != CLEKS_NO_SYMBOL) return true;
+	Cleks__report(clekser, CLEKS_ERROR_MEMORY, token->loc, token->start, "Could not intern \"%.*s\", out of memory!", (int) (token->end - token->start), token->start);
+	return false;
+}
+
+// double the capacity of the symbol columns and the hash table
+CLEKS__PRIVATE bool Cleks__interner_grow(CleksInterner *interner)
+{
+	if (interner->capacity >= CLEKS_NO_SYMBOL/2) return false;
+	uint32_t capacity = (interner->capacity == 0)? 256 : 2*interner->capacity;
+	const char **names = realloc(interner->names, capacity * sizeof(*names));
+	if (names == NULL) return false;
+	interner->names = names;
+	size_t *lengths = realloc(interner->lengths, capacity * sizeof(*lengths));
+	if (lengths == NULL) return false;
+	interner->lengths = lengths;
+	uint64_t *hashes = realloc(interner->hashes, capacity * sizeof(*hashes));
+	if (hashes == NULL) return false;
+	interner->hashes = hashes;
+	interner->capacity = capacity;
+	size_t slots = 2*(size_t) capacity;
+	uint32_t *table = calloc(slots, sizeof(*table));
+	if (table == NULL) return false;
+	for (uint32_t symbol=0; symbol<interner->count; ++symbol){
+		size_t slot = interner->hashes[symbol] & (slots - 1);
+		while (table[slot] != 0) slot = (slot + 1) & (slots - 1);
+		table[slot] = symbol + 1;
+	}
+	free(interner->table);
+	interner->table = table;
+	interner->table_mask = slots - 1;
+	return true;
+}
+
+// the maximum amount of bytes the lexer inspects at once to make a decision
+CLEKS__PRIVATE size_t Cleks__lookahead(Clekser *clekser)
+{
+	const CleksCompiledConfig *compiled = clekser->compiled;
+	const CleksConfig config = *clekser->config;
+	size_t lookahead = 1;
+	for (size_t i=0; i<config.comment_count; ++i){
+		size_t start_len = (compiled != NULL)? compiled->comment_start_lens[i] : strlen(config.comments[i].start_del);
+		size_t end_len = (compiled != NULL)? compiled->comment_end_lens[i] : strlen(config.comments[i].end_del);
+		if (start_len > lookahead) lookahead = start_len;
+		if (end_len > lookahead) lookahead = end_len;
+	}
+	for (size_t i=0; i<config.field_count; ++i){
+		size_t prefix_len = (compiled != NULL)? compiled->field_prefix_lens[i] : strlen(config.fields[i].prefix);
+		size_t suffix_len = (compiled != NULL)? compiled->field_suffix_lens[i] : strlen(config.fields[i].suffix);
+		if (prefix_len > lookahead) lookahead = prefix_len;
+		if (suffix_len > lookahead) lookahead = suffix_len;
+	}
+	return lookahead;
+}
+
+// the offset a token was lexed from, including its delimeter or prefix
+CLEKS__PRIVATE size_t Cleks__token_extent(Clekser *clekser, CleksTokenID id, size_t start)
+{
+	switch (cleks_token_type(id)){
+		case CLEKS_STRING: return start - 1;
+		case CLEKS_FIELD:{
+			CleksTokenIndex index = cleks_token_index(id);
+			return start - ((clekser->compiled != NULL)? clekser->compiled->field_prefix_lens[index] : strlen(clekser->config->fields[index].prefix));
+		}
+		default: return start;
+	}
+}
+
+CLEKS__PRIVATE bool Cleks__index_lines(Clekser *clekser)
+{
+	size_t capacity = 64, count = 0;
+	size_t *starts = malloc(capacity * sizeof(*starts));
+	if (starts == NULL) return false;
+	starts[count++] = 0;
+	const char newline = '\n';
+	size_t i = 0;
+	while ((i = Cleks__find_any(clekser->buffer, i, clekser->buffer_size, &newline, 1)) < clekser->buffer_size){
+		if (count == capacity){
+			size_t *grown = realloc(starts, 2*capacity * sizeof(*starts));
+			if (grown == NULL){
+				free(starts);
+				return false;
+			}
+			starts = grown;
+			capacity *= 2;
+		}
+		starts[count++] = ++i;
+	}
+	clekser->line_starts = starts;
+	clekser->line_count = count;
+	return true;
+}
+
+// map a whole cache file, or read it where mapping is not available, without reporting errors as a missing cache is no error
+CLEKS__PRIVATE bool Cleks__cache_read(CleksTokenCache *cache, const char *path)
+{
+#ifdef CLEKS__POSIX
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	void *data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) return false;
+	cache->data = data;
+	cache->data_size = st.st_size;
+	cache->data_owner = CLEKS__BUFFER_MAPPED;
+	return true;
+#else
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) return false;
+	void *data = NULL;
+	long size = -1;
+	if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+	if (size > 0 && fseek(file, 0, SEEK_SET) == 0) data = malloc(size);
+	if (data != NULL && fread(data, 1, size, file) != (size_t) size){
+		free(data);
+		data = NULL;
+	}
+	fclose(file);
+	if (data == NULL) return false;
+	cache->data = data;
+	cache->data_size = size;
+	cache->data_owner = CLEKS__BUFFER_ALLOCATED;
+	return true;
+#endif
+}
+
+// the index of the last line of a cache starting at or before `offset`
+CLEKS__PRIVATE size_t Cleks__cache_line(const CleksTokenCache *cache, size_t offset)
+{
+	size_t low = 0, high = cache->line_count;
+	while (high - low > 1){
+		size_t mid = low + (high - low)/2;
+		if (Cleks__cache_value(cache->line_starts, cache->wide, mid) <= offset) low = mid;
+		else high = mid;
+	}
+	return low;
+}
+
+// an entry of a cache column, which is either uint32_t or uint64_t
+CLEKS__PRIVATE size_t Cleks__cache_value(const void *column, bool wide, size_t index)
+{
+	return wide? ((const uint64_t*) column)[index] : ((const uint32_t*) column)[index];
+}
+
+// the id of a cached token, unpacked from 32 bits unless the cache is wide
+CLEKS__PRIVATE CleksTokenID Cleks__cache_id(const CleksTokenCache *cache, size_t index)
+{
+	if (cache->wide) return ((const uint64_t*) cache->ids)[index];
+	uint32_t id = ((const uint32_t*) cache->ids)[index];
+	return cleks_token_id(id >> CLEKS__CACHE_INDEX_BITS, id & CLEKS__CACHE_INDEX_MASK);
+}
+
+// fingerprint of everything in a config that changes the tokens, which excludes the print function
+CLEKS__PRIVATE uint64_t Cleks__config_hash(const CleksConfig *config)
+{
+	size_t counts[] = {config->word_count, config->symbol_count, config->string_count, config->field_count, config->comment_count, config->whitespace_count, config->flags};
+	uint64_t hash = Cleks__content_hash(counts, sizeof(counts), 0);
+	// strings are hashed with their terminator, so neighbouring ones cannot be confused
+	for (size_t i=0; i<config->word_count; ++i) hash = Cleks__content_hash(config->words[i], strlen(config->words[i]) + 1, hash);
+	hash = Cleks__content_hash(config->symbols, config->symbol_count, hash);
+	for (size_t i=0; i<config->string_count; ++i){
+		char delimeters[2] = {config->strings[i].start_del, config->strings[i].end_del};
+		hash = Cleks__content_hash(delimeters, sizeof(delimeters), hash);
+	}
+	for (size_t i=0; i<config->field_count; ++i){
+		hash = Cleks__content_hash(config->fields[i].prefix, strlen(config->fields[i].prefix) + 1, hash);
+		hash = Cleks__content_hash(config->fields[i].suffix, strlen(config->fields[i].suffix) + 1, hash);
+	}
+	for (size_t i=0; i<config->comment_count; ++i){
+		hash = Cleks__content_hash(config->comments[i].start_del, strlen(config->comments[i].start_del) + 1, hash);
+		hash = Cleks__content_hash(config->comments[i].end_del, strlen(config->comments[i].end_del) + 1, hash);
+	}
+	return Cleks__content_hash(config->whitespaces, config->whitespace_count, hash);
+}
+
+// the location to report in an error message, `p` points to where `loc` was taken
+CLEKS__PRIVATE CleksLoc Cleks__error_loc(Clekser *clekser, CleksLoc loc, char *p)
+{
+	if ((clekser->config->flags & CLEKS_FLAGS_LAZY_LOC) == 0) return loc;
+	return Cleks_loc_of(clekser, p - clekser->buffer);
+}
+
+static CleksErrorFn Cleks__error_fn = NULL;
+static void *Cleks__error_user = NULL;
+
+void Cleks_set_error_handler(CleksErrorFn fn, void *user)
+{
+	Cleks__error_fn = fn;
+	Cleks__error_user = user;
+}
+
+// record an error in the clekser, if any, and pass it to the error handler unless the clekser is silenced
+CLEKS__PRIVATE void Cleks__report(Clekser *clekser, CleksErrorKind kind, CleksLoc loc, const char *p, const char *format, ...)
+{
+	CleksError error = {.kind=kind, .loc=loc, .offset=0};
+	if (clekser != NULL){
+		error.offset = (p != NULL)? (size_t) (p - clekser->buffer) : clekser->index;
+		clekser->error = error;
+		if (clekser->silent) return;
+	}
+	char message[256];
+	va_list args;
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+	if (Cleks__error_fn != NULL) Cleks__error_fn(Cleks__error_user, error, message);
+	else cleks_error("%s", message);
+}
+
+bool Cleks_stream_create(CleksStream *stream, const CleksConfig *config, CleksReadFn read_fn, void *user, size_t window_size, char *filename)
+{
+	cleks__require(stream != NULL && config != NULL && read_fn != NULL, false, "Invalid arguments stream:%p, config:%p, read_fn:%p", stream, config, read_fn);
+	memset(stream, 0, sizeof(*stream));
+	if (window_size == 0) window_size = 64*1024;
+	stream->compiled = Cleks_compile(config);
+	// one additional byte for a terminating '\0'
+	stream->window = malloc(window_size + 1);
+	if (stream->compiled == NULL || stream->window == NULL){
+		Cleks_stream_destroy(stream);
+		return false;
+	}
+	stream->window[0] = '\0';
+	stream->window_capacity = window_size;
+	stream->read_fn = read_fn;
+	stream->user = user;
+	stream->clekser = Cleks_create_compiled(stream->window, 0, stream->compiled, filename);
+	// a decision is safe once every delimeter that could start at its position fits into the window
+	stream->lookahead = Cleks__lookahead(&stream->clekser);
+	return true;
+}
+
+bool Cleks_stream_next(CleksStream *stream, CleksToken *token)
+{
+	cleks__require(stream != NULL && token != NULL, false, "Invalid arguments stream:%p, token:%p", stream, token);
+	Clekser *clekser = &stream->clekser;
+	bool silent = clekser->silent;
+	while (true){
+		// skipped whitespace and comments never belong to a token, so they can be dropped right away
+		if (stream->in_comment){
+			CleksComment comment = clekser->config->comments[stream->comment];
+			size_t end_len = stream->compiled->comment_end_lens[stream->comment];
+			while (clekser->index + end_len <= clekser->buffer_size && !Cleks__starts_with_n(clekser, comment.end_del, end_len)){
+				clekser__consume(clekser);
+				clekser__stat_add(clekser, comment_bytes, 1);
+				Cleks__advance_to(clekser, Cleks__find_any(clekser->buffer, clekser->index, clekser->buffer_size, comment.end_del, 1));
+			}
+			if (clekser->index + end_len <= clekser->buffer_size){
+				Cleks__skip_string(clekser, end_len);
+				clekser__stat_add(clekser, comment_bytes, end_len);
+				stream->in_comment = false;
+				continue;
+			}
+			if (stream->eof){
+				CleksLoc loc = stream->comment_loc;
+				Cleks__report(clekser, CLEKS_ERROR_UNTERMINATED_COMMENT, loc, NULL, "Expected \"%s\" for matching comment delimeter \"%s\" at %s:%d:%d!", comment.end_del, comment.start_del, CLEKS_LOC_EXPAND(loc));
+				return false;
+			}
+			// at most a part of the end delimeter is left, the rest of the comment is dropped by the refill
+			if (!Cleks__stream_fill(stream)) return false;
+			continue;
+		}
+		Cleks__trim_left(clekser);
+		if (clekser->index >= clekser->buffer_size && !stream->eof){
+			if (!Cleks__stream_fill(stream)) return false;
+			continue;
+		}
+		// a comment start delimeter has to fit into the window to be recognized
+		if (clekser->index + stream->lookahead > clekser->buffer_size && !stream->eof){
+			if (!Cleks__stream_fill(stream)) return false;
+			continue;
+		}
+		CleksTokenIndex comment = (clekser->index < clekser->buffer_size)? Cleks__match_comment(clekser) : CLEKS__NO_MATCH;
+		if (comment != CLEKS__NO_MATCH){
+			stream->in_comment = true;
+			stream->comment = comment;
+			stream->comment_loc = clekser->loc;
+			Cleks__skip_string(clekser, stream->compiled->comment_start_lens[comment]);
+			clekser__stat_add(clekser, comment_bytes, stream->compiled->comment_start_lens[comment]);
+			continue;
+		}
+		size_t index = clekser->index;
+		CleksLoc loc = clekser->loc;
+		// errors close to the end of the window may just be missing input, so only report them at the end
+		clekser->silent = silent || !stream->eof;
+		// a token cut off by the window must not be interned
+		CleksInterner *interner = clekser->interner;
+		clekser->interner = NULL;
+		bool lexed = Cleks__lex(clekser, token);
+		clekser->interner = interner;
+		clekser->silent = silent;
+		if (stream->eof || clekser->index + stream->lookahead <= clekser->buffer_size){
+			if (lexed) return Cleks__intern_token(clekser, token);
+			if (stream->eof) return false;
+			clekser->index = index;
+			clekser->loc = loc;
+			return Cleks__lex(clekser, token);
+		}
+		// the token might continue after the window, try again with more input
+		clekser->index = index;
+		clekser->loc = loc;
+		if (!Cleks__stream_fill(stream)) return false;
+	}
+}
+
+size_t Cleks_stream_offset(const CleksStream *stream, CleksToken token)
+{
+	cleks__require(stream != NULL, 0, "Invalid argument stream:%p", stream);
+	return stream->offset + (token.start - stream->window);
+}
+
+void Cleks_stream_destroy(CleksStream *stream)
+{
+	if (stream == NULL) return;
+	Cleks_compiled_free(stream->compiled);
+	free(stream->window);
+	memset(stream, 0, sizeof(*stream));
+}
+
+size_t Cleks_read_file(void *file, char *buffer, size_t size)
+{
+	return fread(buffer, 1, size, (FILE*) file);
+}
+
+#ifdef CLEKS__POSIX
+size_t Cleks_read_fd(void *fd, char *buffer, size_t size)
+{
+	while (true){
+		ssize_t n = read((int) (intptr_t) fd, buffer, size);
+		if (n >= 0) return n;
+		if (errno != EINTR) return 0;
+	}
+}
+#endif
+
+// drop the consumed part of the window and read more input, growing the window if it is full
+CLEKS__PRIVATE bool Cleks__stream_fill(CleksStream *stream)
+{
+	Clekser *clekser = &stream->clekser;
+	size_t keep = clekser->buffer_size - clekser->index;
+	memmove(stream->window, stream->window + clekser->index, keep);
+	stream->offset += clekser->index;
+	clekser->index = 0;
+	if (keep == stream->window_capacity){
+		char *window = realloc(stream->window, 2*stream->window_capacity + 1);
+		if (window == NULL){
+			Cleks__report(clekser, CLEKS_ERROR_MEMORY, clekser->loc, NULL, "Could not grow the stream window to %zu bytes!", 2*stream->window_capacity);
+			return false;
+		}
+		stream->window = clekser->buffer = window;
+		stream->window_capacity *= 2;
+	}
+	size_t n = stream->read_fn(stream->user, stream->window + keep, stream->window_capacity - keep);
+	if (n == 0) stream->eof = true;
+	clekser->buffer_size = keep + n;
+	stream->window[clekser->buffer_size] = '\0';
+	return true;
+}
+
+CLEKS__PRIVATE bool Cleks__token_buffer_reserve(CleksTokenBuffer *tokens, size_t capacity)
+{
+	if (capacity <= tokens->capacity) return true;
+	// keep every successfully grown column, so the buffer stays valid on failure
+	CleksTokenID *ids = realloc(tokens->ids, capacity * sizeof(*ids));
+	if (ids == NULL) return false;
+	tokens->ids = ids;
+	size_t **columns[] = {&tokens->starts, &tokens->lengths, &tokens->rows, &tokens->columns};
+	for (size_t i=0; i<CLEKS_ARR_LEN(columns); ++i){
+		size_t *column = realloc(*columns[i], capacity * sizeof(size_t));
+		if (column == NULL) return false;
+		*columns[i] = column;
+	}
+	uint32_t *symbols = realloc(tokens->symbols, capacity * sizeof(*symbols));
+	if (symbols == NULL) return false;
+	tokens->symbols = symbols;
+	tokens->capacity = capacity;
+	return true;
+}
+
+// append a token lexed from `buffer`, the capacity has to be reserved already
+CLEKS__PRIVATE void Cleks__token_buffer_push(CleksTokenBuffer *tokens, const char *buffer, CleksToken token)
+{
+	size_t i = tokens->count++;
+	tokens->ids[i] = token.id;
+	tokens->starts[i] = token.start - buffer;
+	tokens->lengths[i] = token.end - token.start;
+	tokens->rows[i] = token.loc.row;
+	tokens->columns[i] = token.loc.column;
+	tokens->symbols[i] = token.symbol;
+}
+
+// the lexing loop shared by Cleks_next and the batch functions
+// take the oldest peeked token, or lex a new one if there is none
+CLEKS__PRIVATE bool Cleks__next(Clekser *clekser, CleksToken *token)
+{
+	if (clekser->peek_count == 0){
+		if (!clekser->peek_failed) return Cleks__lex(clekser, token);
+		clekser->peek_failed = false;
+		return false;
+	}
+	// a token lexed ahead succeeded, so an error reported since (e.g. by Cleks_expect) no longer applies
+	clekser->error.kind = CLEKS_ERROR_NONE;
+	*token = clekser->peeked[clekser->peek_start];
+	clekser->peek_start = (clekser->peek_start + 1) % CLEKS_PEEK_MAX;
+	clekser->peek_count--;
+	return true;
+}
+
+CLEKS__PRIVATE bool Cleks__lex(Clekser *clekser, CleksToken *token)
+{
+#ifdef CLEKS_THREADS
+	if (clekser->pipeline != NULL) return Cleks__pipeline_pop(clekser, token);
+#endif
+	if (clekser->dfa != NULL) return Cleks__lex_dfa(clekser, token);
+	clekser->error.kind = CLEKS_ERROR_NONE;
+	while (true){
+		if (clekser->index >= clekser->buffer_size) return false;
+		// skip spaces
+		clekser__phase_start(trim);
+		Cleks__trim_left(clekser);
+		clekser__phase_end(clekser, CLEKS_PHASE_TRIM, trim);
+		if (clekser->index >= clekser->buffer_size) return false;
+		// skip comments
+		bool comment_found = false;
+		clekser__phase_start(comments);
+		bool skipped = Cleks__try_skip_comments(clekser, &comment_found);
+		clekser__phase_end(clekser, CLEKS_PHASE_COMMENTS, comments);
+		if (!skipped) return false;
+		if (!comment_found) break;
+	}
+	char c = clekser__get_char(clekser);
+	// try to lex string
+	CleksTokenIndex index = Cleks__match_string(clekser, c);
+	if (index != CLEKS__NO_MATCH) return Cleks__lex_string(clekser, token, index);
+	// try to lex symbols
+	index = Cleks__match_symbol(clekser, c);
+	if (index != CLEKS__NO_MATCH){
+		char *p_start = clekser__get_pointer(clekser);
+		Cleks__set_token(token, CLEKS_SYMBOL, index, clekser->loc, p_start, p_start+1);
+		clekser__consume(clekser);
+		clekser__stat_token(clekser, CLEKS_SYMBOL);
+		return true;
+	}
+    
+    // lex fields
+    clekser__phase_start(fields);
+    index = Cleks__match_field(clekser);
+    clekser__phase_end(clekser, CLEKS_PHASE_FIELDS, fields);
+    if (index != CLEKS__NO_MATCH) return Cleks__lex_field(clekser, token, index);
+    
+	clekser__phase_start(words);
+	char *p_start = clekser__get_pointer(clekser);
+	CleksLoc start_loc = clekser->loc;
+	while (clekser->index < clekser->buffer_size && !Cleks__is_word_end(clekser)){
+		clekser__consume(clekser);
+	}
+	char *p_end = clekser__get_pointer(clekser);
+	clekser__phase_end(clekser, CLEKS_PHASE_WORDS, words);
+	clekser__phase_start(classify);
+	bool classified = Cleks__classify_word(clekser, token, start_loc, p_start, p_end);
+	clekser__phase_end(clekser, CLEKS_PHASE_CLASSIFY, classify);
+	return classified;
+}
+
+// lex the string starting at the current position, with `index` into config.strings
+CLEKS__PRIVATE bool Cleks__lex_string(Clekser *clekser, CleksToken *token, CleksTokenIndex index)
+{
+	clekser__phase_start(strings);
+	CleksString string = clekser->config->strings[index];
+	CleksLoc start_loc = clekser->loc;
+	clekser__consume(clekser);
+	char *p_start = clekser__get_pointer(clekser);
+	if (!Cleks__try_find_char(clekser, string.end_del)){
+		CleksLoc loc = Cleks__error_loc(clekser, start_loc, p_start-1);
+		Cleks__report(clekser, CLEKS_ERROR_UNTERMINATED_STRING, loc, p_start-1, "Expected matching '%c' after string delimeter '%c' at %s:%d:%d", string.end_del, string.start_del, CLEKS_LOC_EXPAND(loc));
+		return false;
+	}
+	char *p_end = clekser__get_pointer(clekser);
+	Cleks__set_token(token, CLEKS_STRING, index, start_loc, p_start, p_end); 
+	clekser__consume(clekser);
+	clekser__phase_end(clekser, CLEKS_PHASE_STRINGS, strings);
+	clekser__stat_token(clekser, CLEKS_STRING);
+	return Cleks__intern_token(clekser, token);
+}
+
+// lex the field whose prefix starts at the current position, with `index` into config.fields
+CLEKS__PRIVATE bool Cleks__lex_field(Clekser *clekser, CleksToken *token, CleksTokenIndex index)
+{
+    clekser__phase_start(fields);
+    CleksField field = clekser->config->fields[index];
+    const CleksCompiledConfig *compiled = clekser->compiled;
+    Cleks__skip_string(clekser, (compiled != NULL)? compiled->field_prefix_lens[index] : strlen(field.prefix));
+    char *p_start = clekser__get_pointer(clekser);
+    CleksLoc loc = clekser->loc;
+    size_t suffix_len = (compiled != NULL)? compiled->field_suffix_lens[index] : strlen(field.suffix);
+    if (!Cleks__try_find_string(clekser, field.suffix, suffix_len)){
+        loc = Cleks__error_loc(clekser, loc, p_start);
+        Cleks__report(clekser, CLEKS_ERROR_UNTERMINATED_FIELD, loc, p_start, "Expected \"%s\" for matching field prefix \"%s\" at %s:%d:%d!", field.suffix, field.prefix, CLEKS_LOC_EXPAND(loc));
+        return false;
+    }
+    char *p_end = clekser__get_pointer(clekser);
+    Cleks__skip_string(clekser, suffix_len);
+    Cleks__set_token(token, CLEKS_FIELD, index, loc, p_start, p_end);
+    clekser__phase_end(clekser, CLEKS_PHASE_FIELDS, fields);
+    clekser__stat_token(clekser, CLEKS_FIELD);
+    return true;
+}
+
+// Cleks__lex driven by a CleksDfa, which reads a word and classifies it in the same pass
+CLEKS__PRIVATE bool Cleks__lex_dfa(Clekser *clekser, CleksToken *token)
+{
+	const CleksDfa *dfa = clekser->dfa;
+	const CleksCompiledConfig *compiled = dfa->compiled;
+	clekser->error.kind = CLEKS_ERROR_NONE;
+	uint8_t c, kind;
+	CleksTokenIndex comment, field;
+	while (true){
+		if (clekser->index >= clekser->buffer_size) return false;
+		c = (uint8_t) clekser__get_char(clekser);
+		kind = compiled->classes[c];
+		if (kind & (CLEKS__CLASS_WHITESPACE | CLEKS__CLASS_SPECIAL)){
+			clekser__consume(clekser);
+			clekser__stat_add(clekser, whitespace_bytes, 1);
+			continue;
+		}
+		comment = field = CLEKS__NO_MATCH;
+		if (kind & (CLEKS__CLASS_COMMENT | CLEKS__CLASS_FIELD)) Cleks__dfa_match_prefix(clekser, clekser->index, &comment, &field);
+		if (comment == CLEKS__NO_MATCH) break;
+		if (!Cleks__skip_comment(clekser, comment)) return false;
+	}
+	if (kind & CLEKS__CLASS_STRING) return Cleks__lex_string(clekser, token, compiled->string_index[c]);
+	if (kind & CLEKS__CLASS_SYMBOL){
+		char *p_start = clekser__get_pointer(clekser);
+		Cleks__set_token(token, CLEKS_SYMBOL, compiled->symbol_index[c], clekser->loc, p_start, p_start+1);
+		clekser__consume(clekser);
+		clekser__stat_token(clekser, CLEKS_SYMBOL);
+		return true;
+	}
+	if (field != CLEKS__NO_MATCH) return Cleks__lex_field(clekser, token, field);
+
+	clekser__phase_start(words);
+	const char *buffer = clekser->buffer;
+	size_t start = clekser->index, i = start + 1;
+	// the first byte neither ends the word nor starts a comment or field, as those were handled above
+	uint32_t state = dfa->next[CLEKS__DFA_START*dfa->class_count + dfa->classes[c]];
+	for (; i < clekser->buffer_size; ++i){
+		uint32_t class = dfa->classes[(uint8_t) buffer[i]];
+		uint32_t next = dfa->next[state*dfa->class_count + class];
+		if (next == CLEKS__DFA_END) break;
+		if (class >= dfa->probe_class){
+			Cleks__dfa_match_prefix(clekser, i, &comment, &field);
+			if (comment != CLEKS__NO_MATCH || field != CLEKS__NO_MATCH) break;
+		}
+		state = next;
+	}
+	CleksLoc loc = clekser->loc;
+	Cleks__advance_to(clekser, i);
+	clekser__phase_end(clekser, CLEKS_PHASE_WORDS, words);
+	char *p_start = clekser->buffer + start, *p_end = clekser->buffer + i;
+	CleksTokenID id = dfa->accept[state];
+	if (id == CLEKS__DFA_REJECT){
+		loc = Cleks__error_loc(clekser, loc, p_start);
+		Cleks__report(clekser, CLEKS_ERROR_UNKNOWN_WORD, loc, p_start, "Unknown word found (flags: %d) at %s:%d:%d \"%.*s\"", clekser->config->flags, loc.filename, loc.row, loc.column, (int) (p_end-p_start), p_start);
+		return false;
+	}
+	CleksTokenType type = cleks_token_type(id);
+	Cleks__set_token(token, type, cleks_token_index(id), loc, p_start, p_end);
+	clekser__stat_token(clekser, type);
+	return (type == CLEKS_UNKNOWN)? Cleks__intern_token(clekser, token) : true;
+}
+
+// the structural indexer lexes configs without comments and fields, whose only string delimeter also ends its strings,
+// and whose whitespace, symbol and delimeter bytes fit into 8 classes of one high nibble each, as needed for the nibble lookups
+CLEKS__PRIVATE void Cleks__index_tables(CleksCompiledConfig *compiled)
+{
+	CleksConfig config = compiled->config;
+	if (config.comment_count > 0 || config.field_count > 0) return;
+	uint8_t bits[3][16] = {0}; // the class bit of whitespace, symbols and the delimeter with each high nibble
+	uint8_t low[16] = {0}, high[16] = {0}, masks[3] = {0};
+	unsigned bit_count = 0;
+	int quote = -1;
+	for (int c=0; c<256; ++c){
+		uint8_t kind = compiled->classes[c];
+		int class;
+		// the same precedence as Cleks__lex
+		if (kind & (CLEKS__CLASS_WHITESPACE | CLEKS__CLASS_SPECIAL)) class = 0;
+		else if (kind & CLEKS__CLASS_STRING){
+			if (quote >= 0 || (uint8_t) config.strings[compiled->string_index[c]].end_del != c) return;
+			quote = c;
+			class = 2;
+		}
+		else if (kind & CLEKS__CLASS_SYMBOL) class = 1;
+		else continue;
+		if (bits[class][c >> 4] == 0){
+			if (bit_count == 8) return;
+			bits[class][c >> 4] = 1 << bit_count++;
+		}
+		low[c & 0x0f] |= bits[class][c >> 4];
+		high[c >> 4] |= bits[class][c >> 4];
+		masks[class] |= bits[class][c >> 4];
+	}
+	memcpy(compiled->index_low, low, sizeof(low));
+	memcpy(compiled->index_high, high, sizeof(high));
+	compiled->index_whitespace = masks[0];
+	compiled->index_symbol = masks[1];
+	compiled->index_quote = masks[2];
+	compiled->indexable = true;
+}
+
+// Cleks_tokenize_batch for an indexable config, producing the same tokens and errors as Cleks__lex
+CLEKS__PRIVATE size_t Cleks__tokenize_indexed(Clekser *clekser, CleksTokenBuffer *tokens, size_t max)
+{
+	const CleksCompiledConfig *compiled = clekser->compiled;
+	CleksIndexer indexer = {.compiled=compiled, .buffer=clekser->buffer, .size=clekser->buffer_size, .base=clekser->index, .window=1};
+	clekser->error.kind = CLEKS_ERROR_NONE;
+	if (clekser->index >= clekser->buffer_size) return 0;
+	Cleks__index_fill(&indexer);
+	CleksToken token;
+	size_t appended = 0;
+	size_t position = Cleks__index_next(&indexer);
+	while (appended < max && position < clekser->buffer_size){
+		if (tokens->count == tokens->capacity && !Cleks__token_buffer_reserve(tokens, (tokens->capacity < 256)? 256 : 2*tokens->capacity)) break;
+		uint8_t c = (uint8_t) clekser->buffer[position];
+		uint8_t kind = compiled->classes[c];
+		// the end of the token starting at `position`, or the next token if it is a symbol
+		size_t next = Cleks__index_next(&indexer);
+		if (kind & (CLEKS__CLASS_WHITESPACE | CLEKS__CLASS_SPECIAL)){
+			position = next;
+			continue;
+		}
+		clekser__stat_add(clekser, whitespace_bytes, position - clekser->index);
+		Cleks__advance_to(clekser, position);
+		char *p_start = clekser->buffer + position;
+		if (kind & CLEKS__CLASS_STRING){
+			// the generic lexer reports unterminated strings
+			if (next >= clekser->buffer_size){
+				Cleks__lex(clekser, &token);
+				break;
+			}
+			Cleks__set_token(&token, CLEKS_STRING, compiled->string_index[c], clekser->loc, p_start+1, clekser->buffer+next);
+			Cleks__advance_to(clekser, next+1);
+			clekser__stat_token(clekser, CLEKS_STRING);
+			if (!Cleks__intern_token(clekser, &token)) break;
+			position = Cleks__index_next(&indexer);
+		}
+		else if (kind & CLEKS__CLASS_SYMBOL){
+			Cleks__set_token(&token, CLEKS_SYMBOL, compiled->symbol_index[c], clekser->loc, p_start, p_start+1);
+			clekser__consume(clekser);
+			clekser__stat_token(clekser, CLEKS_SYMBOL);
+			position = next;
+		}
+		else{
+			CleksLoc loc = clekser->loc;
+			Cleks__advance_to(clekser, next);
+			if (!Cleks__classify_word(clekser, &token, loc, p_start, clekser->buffer+next)) break;
+			position = next;
+		}
+		Cleks__token_buffer_push(tokens, clekser->buffer, token);
+		appended++;
+	}
+	// the whitespace at the end of the buffer is skipped when looking for another token
+	if (appended < max && position >= clekser->buffer_size){
+		clekser__stat_add(clekser, whitespace_bytes, clekser->buffer_size - clekser->index);
+		Cleks__advance_to(clekser, clekser->buffer_size);
+	}
+	return appended;
+}
+
+// classify the blocks following the ones walked so far, twice as many as the last time
+CLEKS__PRIVATE void Cleks__index_fill(CleksIndexer *indexer)
+{
+	indexer->base += 64*indexer->block_count;
+	size_t remaining = indexer->size - indexer->base;
+	size_t count = remaining/64;
+	if (count > indexer->window) count = indexer->window;
+	for (size_t i=0; i<count; ++i){
+		indexer->blocks[i] = Cleks__index_block(indexer, indexer->buffer + indexer->base + 64*i);
+	}
+	// the last block is padded with '\0', which is special and ends a word like whitespace
+	if (count < indexer->window && remaining > 64*count){
+		char tail[64] = {0};
+		memcpy(tail, indexer->buffer + indexer->base + 64*count, remaining - 64*count);
+		indexer->blocks[count++] = Cleks__index_block(indexer, tail);
+	}
+	indexer->block_count = count;
+	indexer->block = 0;
+	indexer->bits = indexer->blocks[0];
+	if (indexer->window < CLEKS__INDEX_BLOCKS) indexer->window *= 2;
+}
+
+// the next position a token starts or ends at, or the buffer size once all were walked
+CLEKS__PRIVATE size_t Cleks__index_next(CleksIndexer *indexer)
+{
+	while (indexer->bits == 0){
+		if (++indexer->block < indexer->block_count){
+			indexer->bits = indexer->blocks[indexer->block];
+			continue;
+		}
+		if (indexer->base + 64*indexer->block_count >= indexer->size) return indexer->size;
+		Cleks__index_fill(indexer);
+	}
+	size_t position = indexer->base + 64*indexer->block + Cleks__trailing_zeros(indexer->bits);
+	indexer->bits &= indexer->bits - 1;
+	return (position < indexer->size)? position : indexer->size;
+}
+
+// the structural positions of a block: symbols and delimeters outside of strings, the closing delimeters,
+// the first byte of each word and the first byte after it
+CLEKS__PRIVATE uint64_t Cleks__index_block(CleksIndexer *indexer, const char *block)
+{
+	uint64_t whitespace, symbols, quotes;
+	Cleks__index_classify(indexer->compiled, block, &whitespace, &symbols, &quotes);
+	// the opening delimeter and the content of each string
+	uint64_t strings = Cleks__prefix_xor(quotes) ^ indexer->in_string;
+	indexer->in_string = (uint64_t) ((int64_t) strings >> 63);
+	uint64_t words = ~(whitespace | symbols | quotes | strings);
+	uint64_t after_word = (words << 1) | indexer->after_word;
+	indexer->after_word = words >> 63;
+	return (symbols & ~strings) | quotes | (words & ~after_word) | (~words & after_word);
+}
+
+// the bitmaps of whitespace, symbol and delimeter bytes within 64 bytes, looking up the classes of both nibbles of each byte
+CLEKS__PRIVATE void Cleks__index_classify(const CleksCompiledConfig *compiled, const char *block, uint64_t *whitespace, uint64_t *symbols, uint64_t *quotes)
+{
+	uint64_t w = 0, s = 0, q = 0;
+#if defined(__AVX2__)
+	const __m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) compiled->index_low));
+	const __m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*) compiled->index_high));
+	const __m256i nibble = _mm256_set1_epi8(0x0f), zero = _mm256_setzero_si256();
+	const __m256i w_mask = _mm256_set1_epi8(compiled->index_whitespace), s_mask = _mm256_set1_epi8(compiled->index_symbol), q_mask = _mm256_set1_epi8(compiled->index_quote);
+	for (int i=0; i<64; i+=32){
+		__m256i chunk = _mm256_loadu_si256((const __m256i*) (block + i));
+		__m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(low, _mm256_and_si256(chunk, nibble)), _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibble)));
+		w |= (uint64_t) (uint32_t) ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(classes, w_mask), zero)) << i;
+		s |= (uint64_t) (uint32_t) ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(classes, s_mask), zero)) << i;
+		q |= (uint64_t) (uint32_t) ~_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(classes, q_mask), zero)) << i;
+	}
+#elif defined(__SSSE3__)
+	const __m128i low = _mm_loadu_si128((const __m128i*) compiled->index_low);
+	const __m128i high = _mm_loadu_si128((const __m128i*) compiled->index_high);
+	const __m128i nibble = _mm_set1_epi8(0x0f), zero = _mm_setzero_si128();
+	const __m128i w_mask = _mm_set1_epi8(compiled->index_whitespace), s_mask = _mm_set1_epi8(compiled->index_symbol), q_mask = _mm_set1_epi8(compiled->index_quote);
+	for (int i=0; i<64; i+=16){
+		__m128i chunk = _mm_loadu_si128((const __m128i*) (block + i));
+		__m128i classes = _mm_and_si128(_mm_shuffle_epi8(low, _mm_and_si128(chunk, nibble)), _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(chunk, 4), nibble)));
+		w |= (uint64_t) (~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(classes, w_mask), zero)) & 0xFFFF) << i;
+		s |= (uint64_t) (~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(classes, s_mask), zero)) & 0xFFFF) << i;
+		q |= (uint64_t) (~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(classes, q_mask), zero)) & 0xFFFF) << i;
+	}
+#else
+	for (int i=0; i<64; ++i){
+		uint8_t c = (uint8_t) block[i];
+		uint8_t classes = compiled->index_low[c & 0x0f] & compiled->index_high[c >> 4];
+		w |= (uint64_t) ((classes & compiled->index_whitespace) != 0) << i;
+		s |= (uint64_t) ((classes & compiled->index_symbol) != 0) << i;
+		q |= (uint64_t) ((classes & compiled->index_quote) != 0) << i;
+	}
+#endif
+	*whitespace = w;
+	*symbols = s;
+	*quotes = q;
+}
+
+// bit i of the result is the parity of the bits 0 to i
+CLEKS__PRIVATE uint64_t Cleks__prefix_xor(uint64_t bits)
+{
+#if defined(__PCLMUL__)
+	// carry-less multiplication by all ones
+	return (uint64_t) _mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, (int64_t) bits), _mm_set1_epi8((char) 0xFF), 0));
+#else
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+#endif
+}
+
+CLEKS__PRIVATE unsigned Cleks__trailing_zeros(uint64_t bits)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(bits);
+#else
+	unsigned count = 0;
+	while ((bits >> count & 1) == 0) count++;
+	return count;
+#endif
+}
+
+bool Cleks_expect(Clekser *clekser, CleksToken *token, CleksTokenID id)
+{
+	cleks__require(clekser != NULL && token != NULL, false, "Invalid arguments clekser:%p, token:%p", clekser, token);
+	CleksToken t_token;
+	if (!Cleks__next(clekser, &t_token)) return false;
+	if (!Cleks__token_matches(t_token.id, id)){
+		CleksTokenType type = cleks_token_type(id);
+		CleksTokenIndex index = cleks_token_index(id);
+		Cleks__report(clekser, CLEKS_ERROR_UNEXPECTED_TOKEN, t_token.loc, t_token.start, "Expected: %s:%d, but got %s:%d!", cleks_token_type_name(type), (index == CLEKS_ANY_INDEX ? 0 : index), cleks_token_type_name(cleks_token_type(t_token.id)), cleks_token_index(t_token.id));
+		return false;
+	}
+	*token = t_token;
+	return true;
+}
+
+bool Cleks_accept(Clekser *clekser, CleksToken *token, CleksTokenID id)
+{
+	cleks__require(clekser != NULL && token != NULL, false, "Invalid arguments clekser:%p, token:%p", clekser, token);
+	CleksToken t_token;
+	// a failure stays in the ring, so Cleks_next still returns it in sequence
+	if (!Cleks_peek(clekser, 0, &t_token) || !Cleks__token_matches(t_token.id, id)) return false;
+	return Cleks__next(clekser, token);
+}
+
+// whether a token id is of the type and index of `id`, which may be CLEKS_ANY_INDEX
+CLEKS__PRIVATE bool Cleks__token_matches(CleksTokenID token, CleksTokenID id)
+{
+	CleksTokenIndex index = cleks_token_index(id);
+	return cleks_token_type(token) == cleks_token_type(id) && (index == CLEKS_ANY_INDEX || cleks_token_index(token) == index);
+}
+
+bool Cleks_token_to_i64(CleksToken token, int64_t *value)
+{
+	cleks__require(value != NULL, false, "Invalid argument value:%p", value);
+	const char *s = token.start;
+	CleksTokenType type = Cleks__scan_number(s, token.end);
+	if (type != CLEKS_INTEGER && type != CLEKS_HEX && type != CLEKS_BIN) return false;
+	bool negative = *s == '-';
+	if (*s == '-' || *s == '+') s++;
+	uint64_t magnitude;
+	if (!Cleks__parse_u64(s, token.end, &magnitude)) return false;
+	if (magnitude > (uint64_t) INT64_MAX + negative) return false;
+	*value = negative? (int64_t) (0 - magnitude) : (int64_t) magnitude;
+	return true;
+}
+
+bool Cleks_token_to_u64(CleksToken token, uint64_t *value)
+{
+	cleks__require(value != NULL, false, "Invalid argument value:%p", value);
+	const char *s = token.start;
+	CleksTokenType type = Cleks__scan_number(s, token.end);
+	if ((type != CLEKS_INTEGER && type != CLEKS_HEX && type != CLEKS_BIN) || *s == '-') return false;
+	if (*s == '+') s++;
+	return Cleks__parse_u64(s, token.end, value);
+}
+
+bool Cleks_token_to_double(CleksToken token, double *value)
+{
+	cleks__require(value != NULL, false, "Invalid argument value:%p", value);
+	// exactly representable powers of ten
+	static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	const char *s = token.start, *e = token.end;
+	bool negative = s < e && *s == '-';
+	if (s < e && (*s == '-' || *s == '+')) s++;
+	// validate and read the digits in one pass, the mantissa may wrap around for more than 19 digits
+	const char *digits = s;
+	uint64_t mantissa = 0;
+	while (e - s >= 8 && Cleks__is_eight_digits(s)){
+		mantissa = 100000000*mantissa + Cleks__parse_eight_digits(s);
+		s += 8;
+	}
+	for (; s < e && (uint8_t) (*s - '0') < 10; ++s) mantissa = 10*mantissa + (*s - '0');
+	size_t digit_count = s - digits;
+	int64_t exponent = 0;
+	if (s < e && *s == '.'){
+		const char *fraction = ++s;
+		while (e - s >= 8 && Cleks__is_eight_digits(s)){
+			mantissa = 100000000*mantissa + Cleks__parse_eight_digits(s);
+			s += 8;
+		}
+		for (; s < e && (uint8_t) (*s - '0') < 10; ++s) mantissa = 10*mantissa + (*s - '0');
+		exponent = fraction - s;
+		digit_count += s - fraction;
+	}
+	const char *digits_end = s;
+	if (digit_count == 0 || (s < e && (*s | 0x20) != 'e')){
+		// not a decimal number, but it might be one of the other number literals
+		switch (Cleks__scan_number(token.start, e)){
+			case CLEKS_HEX:
+			case CLEKS_BIN:{
+				uint64_t integer;
+				if (!Cleks__parse_u64(token.start, e, &integer)) return false;
+				*value = (double) integer;
+				return true;
+			}
+			case CLEKS_FLOAT:
+				if (digit_count == 0 && (*digits | 0x20) != '.'){
+					*value = ((*digits | 0x20) == 'i')? INFINITY : NAN;
+					if (negative) *value = -*value;
+					return true;
+				}
+				break;
+			default: break;
+		}
+		return false;
+	}
+	int64_t explicit_exponent = 0;
+	if (s < e){
+		bool exponent_negative = ++s < e && *s == '-';
+		if (s < e && (*s == '-' || *s == '+')) s++;
+		if (s == e) return false;
+		// larger exponents overflow or underflow any double anyway
+		for (; s < e && (uint8_t) (*s - '0') < 10; ++s) if (explicit_exponent < 100000) explicit_exponent = 10*explicit_exponent + (*s - '0');
+		if (s < e) return false;
+		if (exponent_negative) explicit_exponent = -explicit_exponent;
+	}
+	exponent += explicit_exponent;
+	bool truncated = false;
+	if (digit_count > 19){
+		// leading zeros do not count, otherwise only keep the first 19 significant digits
+		const char *p = digits;
+		while (p < digits_end && (*p == '0' || *p == '.')) p++;
+		digit_count -= p - digits - (p > digits && memchr(digits, '.', p - digits) != NULL);
+		if (digit_count > 19){
+			mantissa = 0;
+			exponent = explicit_exponent;
+			bool fraction = false;
+			int significant = 0;
+			for (p = digits; p < digits_end; ++p){
+				if (*p == '.'){
+					fraction = true;
+					continue;
+				}
+				uint8_t digit = *p - '0';
+				if (significant < 19){
+					mantissa = 10*mantissa + digit;
+					significant += mantissa != 0;
+					exponent -= fraction;
+				}
+				else{
+					truncated |= digit != 0;
+					exponent += !fraction;
+				}
+			}
+		}
+	}
+	// both the mantissa and the power of ten are exact, so a single rounding step is correct
+	if (!truncated && (mantissa >> 53) == 0){
+		double result = (double) mantissa;
+		if (mantissa == 0 || exponent == 0){
+			*value = negative? -result : result;
+			return true;
+		}
+		if (exponent > 0 && exponent <= 22 + 15){
+			// move some of a larger power into the mantissa, as long as it stays exact
+			int64_t power = exponent;
+			if (power > 22){
+				result *= powers[power - 22];
+				power = 22;
+			}
+			if (result <= 1e15){
+				result *= powers[power];
+				*value = negative? -result : result;
+				return true;
+			}
+		}
+		else if (exponent < 0 && exponent >= -22){
+			result /= powers[-exponent];
+			*value = negative? -result : result;
+			return true;
+		}
+	}
+	double result = Cleks__eisel_lemire(mantissa, exponent);
+	// dropped digits only matter if they could change the rounding
+	if (!truncated || result == Cleks__eisel_lemire(mantissa + 1, exponent)){
+		*value = negative? -result : result;
+		return true;
+	}
+	// read all of the digits again at arbitrary precision
+	CleksDecimal decimal = {0};
+	bool point = false;
+	for (s = digits; s < digits_end; ++s){
+		if (*s == '.'){
+			decimal.point = decimal.count;
+			point = true;
+			continue;
+		}
+		uint8_t digit = *s - '0';
+		if (digit == 0 && decimal.count == 0){
+			// leading zeros only move the decimal point
+			decimal.point--;
+			continue;
+		}
+		if (decimal.count < CLEKS__DECIMAL_DIGITS) decimal.digits[decimal.count++] = digit;
+		else if (digit != 0) decimal.truncated = true;
+	}
+	if (!point) decimal.point = decimal.count;
+	decimal.point += explicit_exponent;
+	*value = Cleks__decimal_to_double(&decimal, negative);
+	return true;
+}
+
+bool Cleks_extract(CleksToken *token, char *buffer, size_t buffer_size)
+{
+	if (token == NULL || buffer == NULL) return false;
+	if (cleks_token_type(token->id) == CLEKS_STRING){
+		return Cleks_unescape(token->start, token->end, buffer, buffer_size) <= buffer_size;
+	}
+	size_t value_len = token->end - token->start;
+	if (value_len >= buffer_size) return false;
+	memcpy(buffer, token->start, value_len);
+	buffer[value_len] = '\0';
+	return true;
+}
+
+size_t Cleks_unescape(const char *start, const char *end, char *buffer, size_t buffer_size)
+{
+	cleks__require(start != NULL && end >= start, 0, "Invalid arguments start:%p, end:%p", start, end);
+	size_t size = end - start;
+	size_t index = 0, written = 0;
+	// one byte is kept for the terminating '\0'
+	size_t space = (buffer != NULL && buffer_size > 0)? buffer_size - 1 : 0;
+	const char backslash = '\\';
+	while (index < size){
+		// copy everything up to the next escape sequence at once
+		size_t next = Cleks__find_any(start, index, size, &backslash, 1);
+		Cleks__write(buffer, space, &written, start + index, next - index);
+		if (next == size) break;
+		char decoded[4];
+		size_t consumed;
+		size_t decoded_len = Cleks__decode_escape(start + next, end, decoded, &consumed);
+		Cleks__write(buffer, space, &written, decoded, decoded_len);
+		index = next + consumed;
+	}
+	if (buffer != NULL && buffer_size > 0) buffer[(written < space)? written : space] = '\0';
+	return written + 1;
+}
+
+#ifdef CLEKS_STATS
+void Cleks_stats_dump(const Clekser *clekser, FILE *file)
+{
+	cleks__require(clekser != NULL && file != NULL, , "Invalid arguments clekser:%p, file:%p", clekser, file);
+	static const char *phase_names[] = {
+		[CLEKS_PHASE_TRIM] = "trim",
+		[CLEKS_PHASE_COMMENTS] = "comments",
+		[CLEKS_PHASE_STRINGS] = "strings",
+		[CLEKS_PHASE_FIELDS] = "fields",
+		[CLEKS_PHASE_WORDS] = "words",
+		[CLEKS_PHASE_CLASSIFY] = "classify"
+	};
+	const CleksStats *stats = &clekser->stats;
+	size_t token_count = 0;
+	for (size_t i=0; i<CLEKS_TOKEN_TYPE_COUNT; ++i) token_count += stats->tokens[i];
+	fprintf(file, "whitespace bytes: %zu\n", stats->whitespace_bytes);
+	fprintf(file, "comment bytes:    %zu\n", stats->comment_bytes);
+	fprintf(file, "prefix probes:    %zu\n", stats->prefix_probes);
+	fprintf(file, "word compares:    %zu\n", stats->word_compares);
+	fprintf(file, "number scans:     %zu\n", stats->number_scans);
+	fprintf(file, "tokens:           %zu\n", token_count);
+	for (size_t i=0; i<CLEKS_TOKEN_TYPE_COUNT; ++i){
+		fprintf(file, "    %-8s %zu\n", cleks_token_type_name(i), stats->tokens[i]);
+	}
+#ifdef CLEKS_STATS_CYCLES
+	uint64_t total = 0;
+	for (size_t i=0; i<CLEKS_PHASE_COUNT; ++i) total += stats->cycles[i];
+	fprintf(file, "cycles:           %llu\n", (unsigned long long) total);
+	for (size_t i=0; i<CLEKS_PHASE_COUNT; ++i){
+		fprintf(file, "    %-8s %llu (%.1f%%)\n", phase_names[i], (unsigned long long) stats->cycles[i], (total > 0)? 100.0*stats->cycles[i]/total : 0.0);
+	}
+#else
+	(void) phase_names;
+#endif
+}
+
+void Cleks_stats_reset(Clekser *clekser)
+{
+	cleks__require(clekser != NULL, , "Invalid argument clekser:%p", clekser);
+	memset(&clekser->stats, 0, sizeof(clekser->stats));
+}
+#endif
+
+#if defined(CLEKS_STATS) && defined(CLEKS_STATS_CYCLES)
+// a cheap timestamp: the time stamp counter where available, nanoseconds otherwise
+CLEKS__PRIVATE uint64_t Cleks__cycles(void)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	return __builtin_ia32_rdtsc();
+#elif defined(__GNUC__) && defined(__aarch64__)
+	uint64_t ticks;
+	__asm__ volatile ("mrs %0, cntvct_el0" : "=r" (ticks));
+	return ticks;
+#elif defined(CLEKS__POSIX)
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#else
+	return (uint64_t) clock();
+#endif
+}
+#endif
+
+void Cleks_print_default(const Clekser *clekser, CleksToken token)
+{
+	// TODO: probably best to do this with string builders instead
+    if (token.loc.filename != NULL) printf("%s:", token.loc.filename);
+	CleksTokenType type = cleks_token_type(token.id);
+    CleksTokenIndex index = cleks_token_index(token.id);
+    bool keep_unknown = (type == CLEKS_UNKNOWN && index == 1);
+	printf("%d:%d %s: ", token.loc.row, token.loc.column, (keep_unknown)? "":cleks_token_type_name(type));
+	cleks__require(type < CLEKS_TOKEN_TYPE_COUNT, , "Invalid token type: %u!", type);
+	switch(type){
+		case CLEKS_WORD:
+		case CLEKS_SYMBOL: printf("'%.*s'", token.end-token.start, token.start); break;
+        case CLEKS_FIELD: printf("<%s '%.*s' %s>", clekser->config->fields[index].prefix, token.end-token.start, token.start, clekser->config->fields[index].suffix); break;
+		case CLEKS_STRING: printf("\"%.*s\"", token.end-token.start, token.start); break;
+		case CLEKS_INTEGER:
+		case CLEKS_FLOAT: 
+		case CLEKS_HEX: 
+		case CLEKS_BIN: printf("%.*s", token.end-token.start, token.start); break;
+		case CLEKS_UNKNOWN: {
+            if (keep_unknown){printf("%.*s", token.end-token.start, token.start);}
+            else {printf("`%.*s`", token.end-token.start, token.start);}
+        } break;
+		default: Cleks__report(NULL, CLEKS_ERROR_ARGUMENT, token.loc, NULL, "Uninplemented type in print: %s", cleks_token_type_name(type)); return;
+	}
+    putchar('\n');
+}
+
+void Cleks_print(const Clekser *clekser, CleksToken token)
+{
+	cleks__require(clekser != NULL, , "Invalid argument clekser:%p", clekser);
+	if (clekser->config->print_fn != NULL){
+        clekser->config->print_fn(token);
+    }
+    else{
+        Cleks_print_default(clekser, token);
+    }
+}
+
+#ifdef CLEKS__POSIX
+
+// append a string literal to a writer
+#define cleks__writer_literal(writer, str) Cleks__writer_put((writer), (str), sizeof(str) - 1)
+
+bool Cleks_writer_create(CleksWriter *writer, int fd, CleksFormat format, size_t capacity)
+{
+	cleks__require(writer != NULL && fd >= 0 && format < CLEKS_FORMAT_COUNT, false, "Invalid arguments writer:%p, fd:%d, format:%d", writer, fd, format);
+	if (capacity == 0) capacity = CLEKS__WRITER_CAPACITY;
+	*writer = (CleksWriter) {.fd = fd, .format = format, .capacity = capacity};
+	writer->buffer = malloc(capacity);
+	if (writer->buffer == NULL){
+		Cleks__report(NULL, CLEKS_ERROR_MEMORY, (CleksLoc) {0}, NULL, "Could not allocate a writer buffer of %zu bytes", capacity);
+		return false;
+	}
+	if (format == CLEKS_FORMAT_TSV) cleks__writer_literal(writer, "file\trow\tcolumn\ttype\tindex\tvalue\n");
+	return true;
+}
+
+bool Cleks_write_token(CleksWriter *writer, const Clekser *clekser, CleksToken token)
+{
+	cleks__require(writer != NULL && writer->buffer != NULL && clekser != NULL, false, "Invalid arguments writer:%p, clekser:%p", writer, clekser);
+	CleksTokenType type = cleks_token_type(token.id);
+	CleksTokenIndex index = cleks_token_index(token.id);
+	cleks__require(type < CLEKS_TOKEN_TYPE_COUNT, false, "Invalid token type: %u!", type);
+	const char *filename = token.loc.filename;
+	const char *type_name = cleks_token_type_name(type);
+	switch (writer->format){
+		case CLEKS_FORMAT_TEXT:{
+			// the same as Cleks_print_default
+			bool keep_unknown = (type == CLEKS_UNKNOWN && index == 1);
+			if (filename != NULL){
+				Cleks__writer_put(writer, filename, strlen(filename));
+				cleks__writer_literal(writer, ":");
+			}
+			Cleks__writer_uint(writer, token.loc.row);
+			cleks__writer_literal(writer, ":");
+			Cleks__writer_uint(writer, token.loc.column);
+			cleks__writer_literal(writer, " ");
+			if (!keep_unknown) Cleks__writer_put(writer, type_name, strlen(type_name));
+			cleks__writer_literal(writer, ": ");
+			switch (type){
+				case CLEKS_WORD:
+				case CLEKS_SYMBOL:
+					cleks__writer_literal(writer, "'");
+					Cleks__writer_put(writer, token.start, token.end - token.start);
+					cleks__writer_literal(writer, "'");
+					break;
+				case CLEKS_FIELD:{
+					const char *prefix = clekser->config->fields[index].prefix, *suffix = clekser->config->fields[index].suffix;
+					cleks__writer_literal(writer, "<");
+					Cleks__writer_put(writer, prefix, strlen(prefix));
+					cleks__writer_literal(writer, " '");
+					Cleks__writer_put(writer, token.start, token.end - token.start);
+					cleks__writer_literal(writer, "' ");
+					Cleks__writer_put(writer, suffix, strlen(suffix));
+					cleks__writer_literal(writer, ">");
+				} break;
+				case CLEKS_STRING:
+					cleks__writer_literal(writer, "\"");
+					Cleks__writer_put(writer, token.start, token.end - token.start);
+					cleks__writer_literal(writer, "\"");
+					break;
+				case CLEKS_UNKNOWN:
+					if (!keep_unknown) cleks__writer_literal(writer, "`");
+					Cleks__writer_put(writer, token.start, token.end - token.start);
+					if (!keep_unknown) cleks__writer_literal(writer, "`");
+					break;
+				default: Cleks__writer_put(writer, token.start, token.end - token.start);
+			}
+			cleks__writer_literal(writer, "\n");
+		} break;
+		case CLEKS_FORMAT_TSV:{
+			if (filename != NULL) Cleks__writer_escaped(writer, filename, filename + strlen(filename), false);
+			cleks__writer_literal(writer, "\t");
+			Cleks__writer_uint(writer, token.loc.row);
+			cleks__writer_literal(writer, "\t");
+			Cleks__writer_uint(writer, token.loc.column);
+			cleks__writer_literal(writer, "\t");
+			Cleks__writer_put(writer, type_name, strlen(type_name));
+			cleks__writer_literal(writer, "\t");
+			Cleks__writer_uint(writer, index);
+			cleks__writer_literal(writer, "\t");
+			Cleks__writer_escaped(writer, token.start, token.end, false);
+			cleks__writer_literal(writer, "\n");
+		} break;
+		default:{
+			if (filename != NULL){
+				cleks__writer_literal(writer, "{\"file\": \"");
+				Cleks__writer_escaped(writer, filename, filename + strlen(filename), true);
+				cleks__writer_literal(writer, "\", \"row\": ");
+			}
+			else cleks__writer_literal(writer, "{\"row\": ");
+			Cleks__writer_uint(writer, token.loc.row);
+			cleks__writer_literal(writer, ", \"column\": ");
+			Cleks__writer_uint(writer, token.loc.column);
+			cleks__writer_literal(writer, ", \"type\": \"");
+			Cleks__writer_put(writer, type_name, strlen(type_name));
+			cleks__writer_literal(writer, "\", \"index\": ");
+			Cleks__writer_uint(writer, index);
+			cleks__writer_literal(writer, ", \"value\": \"");
+			Cleks__writer_escaped(writer, token.start, token.end, true);
+			cleks__writer_literal(writer, "\"}\n");
+		}
+	}
+	return !writer->failed;
+}
+
+bool Cleks_writer_flush(CleksWriter *writer)
+{
+	cleks__require(writer != NULL, false, "Invalid argument writer:%p", writer);
+	size_t written = 0;
+	while (written < writer->used && !writer->failed){
+		ssize_t n = write(writer->fd, writer->buffer + written, writer->used - written);
+		if (n > 0) written += n;
+		else if (n < 0 && errno == EINTR) continue;
+		else{
+			Cleks__report(NULL, CLEKS_ERROR_IO, (CleksLoc) {0}, NULL, "Could not write tokens to fd %d: %s", writer->fd, (n < 0)? strerror(errno) : "nothing was written");
+			writer->failed = true;
+		}
+	}
+	writer->used = 0;
+	return !writer->failed;
+}
+
+bool Cleks_writer_destroy(CleksWriter *writer)
+{
+	if (writer == NULL) return false;
+	bool written = writer->buffer != NULL && Cleks_writer_flush(writer);
+	free(writer->buffer);
+	memset(writer, 0, sizeof(*writer));
+	return written;
+}
+
+// append bytes to a writer, flushing whenever its buffer is full
+CLEKS__PRIVATE void Cleks__writer_put(CleksWriter *writer, const char *src, size_t len)
+{
+	while (len > 0){
+		if (writer->used == writer->capacity) Cleks_writer_flush(writer);
+		size_t n = writer->capacity - writer->used;
+		if (n > len) n = len;
+		memcpy(writer->buffer + writer->used, src, n);
+		writer->used += n;
+		src += n;
+		len -= n;
+	}
+}
+
+// append the decimal digits of a number, two at a time
+CLEKS__PRIVATE void Cleks__writer_uint(CleksWriter *writer, size_t value)
+{
+	static const char pairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+	char digits[20];
+	char *p = digits + sizeof(digits);
+	while (value >= 100){
+		size_t pair = value % 100 * 2;
+		value /= 100;
+		*--p = pairs[pair + 1];
+		*--p = pairs[pair];
+	}
+	if (value >= 10){
+		*--p = pairs[value*2 + 1];
+		*--p = pairs[value*2];
+	}
+	else *--p = '0' + value;
+	Cleks__writer_put(writer, p, digits + sizeof(digits) - p);
+}
+
+// append a lexeme, escaping what would break a TSV field or a JSON string, runs of plain bytes are copied at once
+CLEKS__PRIVATE void Cleks__writer_escaped(CleksWriter *writer, const char *start, const char *end, bool json)
+{
+	static const char hex[] = "0123456789abcdef";
+	const char *run = start;
+	for (const char *p=start; p<end; ++p){
+		uint8_t c = *p;
+		bool special = json? (c < 0x20 || c == '"' || c == '\\') : (c == '\t' || c == '\n' || c == '\r' || c == '\\');
+		if (!special) continue;
+		Cleks__writer_put(writer, run, p - run);
+		run = p + 1;
+		char escape[6] = {'\\', c};
+		size_t len = 2;
+		switch (c){
+			case '\t': escape[1] = 't'; break;
+			case '\n': escape[1] = 'n'; break;
+			case '\r': escape[1] = 'r'; break;
+			case '"':
+			case '\\': break;
+			default:
+				memcpy(escape + 1, "u00", 3);
+				escape[4] = hex[c >> 4];
+				escape[5] = hex[c & 0xf];
+				len = 6;
+		}
+		Cleks__writer_put(writer, escape, len);
+	}
+	Cleks__writer_put(writer, run, end - run);
+}
+
+#endif // CLEKS__POSIX
+
+// copy as much of `src` as fits into the remaining space of a buffer, while counting all of it
+CLEKS__PRIVATE void Cleks__write(char *buffer, size_t space, size_t *written, const char *src, size_t len)
+{
+	if (*written < space) memcpy(buffer + *written, src, (len < space - *written)? len : space - *written);
+	*written += len;
+}
+
+// decode the escape sequence `p` points to, returns the amount of bytes written to `out` and sets the amount of bytes read
+CLEKS__PRIVATE size_t Cleks__decode_escape(const char *p, const char *end, char *out, size_t *consumed)
+{
+	*consumed = 2;
+	// a trailing backslash stays as it is
+	if (end - p < 2){
+		*consumed = 1;
+		out[0] = '\\';
+		return 1;
+	}
+	switch (p[1]){
+		case '\'': out[0] = 0x27; return 1;
+		case '"':  out[0] = 0x22; return 1;
+		case '?':  out[0] = 0x3f; return 1;
+		case '\\': out[0] = 0x5c; return 1;
+		case 'a':  out[0] = 0x07; return 1;
+		case 'b':  out[0] = 0x08; return 1;
+		case 'f':  out[0] = 0x0c; return 1;
+		case 'n':  out[0] = 0x0a; return 1;
+		case 'r':  out[0] = 0x0d; return 1;
+		case 't':  out[0] = 0x09; return 1;
+		case 'v':  out[0] = 0x0b; return 1;
+		case 'x':{
+			int32_t value = Cleks__hex_value(p + 2, end, 2);
+			if (value < 0) break;
+			*consumed = 4;
+			out[0] = (char) value;
+			return 1;
+		}
+		case 'u':{
+			int32_t value = Cleks__hex_value(p + 2, end, 4);
+			if (value < 0) break;
+			*consumed = 6;
+			if (value >= 0xD800 && value <= 0xDFFF){
+				// combine a surrogate pair, lone surrogates become U+FFFD
+				int32_t low = (value <= 0xDBFF && end - p >= 12 && p[6] == '\\' && p[7] == 'u')? Cleks__hex_value(p + 8, end, 4) : -1;
+				if (low >= 0xDC00 && low <= 0xDFFF){
+					*consumed = 12;
+					value = 0x10000 + ((value - 0xD800) << 10) + (low - 0xDC00);
+				}
+				else value = 0xFFFD;
+			}
+			return Cleks__utf8_encode((uint32_t) value, out);
+		}
+		default: break;
+	}
+	// unknown escape sequences are kept
+	out[0] = '\\';
+	out[1] = p[1];
+	return 2;
+}
+
+// the value of exactly `digits` hex digits, -1 if there are fewer
+CLEKS__PRIVATE int32_t Cleks__hex_value(const char *p, const char *end, size_t digits)
+{
+	if ((size_t) (end - p) < digits) return -1;
+	int32_t value = 0;
+	for (size_t i=0; i<digits; ++i){
+		uint8_t c = (uint8_t) p[i];
+		if ((uint8_t) (c - '0') < 10) value = 16*value + (c - '0');
+		else if ((uint8_t) ((c | 0x20) - 'a') < 6) value = 16*value + ((c | 0x20) - 'a' + 10);
+		else return -1;
+	}
+	return value;
+}
+
+// write the UTF-8 encoding of a code point, returns its length
+CLEKS__PRIVATE size_t Cleks__utf8_encode(uint32_t code_point, char *out)
+{
+	if (code_point < 0x80){
+		out[0] = (char) code_point;
+		return 1;
+	}
+	if (code_point < 0x800){
+		out[0] = (char) (0xC0 | (code_point >> 6));
+		out[1] = (char) (0x80 | (code_point & 0x3F));
+		return 2;
+	}
+	if (code_point < 0x10000){
+		out[0] = (char) (0xE0 | (code_point >> 12));
+		out[1] = (char) (0x80 | ((code_point >> 6) & 0x3F));
+		out[2] = (char) (0x80 | (code_point & 0x3F));
+		return 3;
+	}
+	out[0] = (char) (0xF0 | (code_point >> 18));
+	out[1] = (char) (0x80 | ((code_point >> 12) & 0x3F));
+	out[2] = (char) (0x80 | ((code_point >> 6) & 0x3F));
+	out[3] = (char) (0x80 | (code_point & 0x3F));
+	return 4;
+}
+
+CLEKS__PRIVATE void Cleks__trim_left(Clekser *clekser)
+{
+	cleks__check(clekser != NULL, "Invalid argument clekser:%p", clekser);
+	char c;
+	while (clekser->index < clekser->buffer_size && (Cleks__is_whitespace(clekser, (c = clekser__get_char(clekser))) || cleks__is_special(c))){
+		clekser__consume(clekser);
+		clekser__stat_add(clekser, whitespace_bytes, 1);
+	}
+}
+
+CLEKS__PRIVATE void Cleks__skip_string(Clekser *clekser, size_t len)
+{
+	cleks__check(clekser != NULL, "Invalid argument clekser:%p", clekser);
+	for (size_t i=0; i<len && clekser->index < clekser->buffer_size; ++i){
+		clekser__consume(clekser);
+	}
+}
+
+CLEKS__PRIVATE bool Cleks__find_string(Clekser *clekser, char *del, size_t del_len)
+{
+	cleks__check(clekser != NULL && del != NULL, "Invalid arguments clekser:%p, del:%p", clekser, del);
+	while (!Cleks__starts_with_n(clekser, del, del_len)){
+		if (clekser->index >= clekser->buffer_size) return false;
+		clekser__consume(clekser);
+		// the delimeter can only start at its first byte
+		Cleks__advance_to(clekser, Cleks__find_any(clekser->buffer, clekser->index, clekser->buffer_size, del, 1));
+	}
+    return true;
+}
+
+CLEKS__PRIVATE bool Cleks__find_char(Clekser *clekser, char del)
+{
+	cleks__check(clekser != NULL, "Invalid argument clekser:%p", clekser);
+	while (clekser->index >= clekser->buffer_size || clekser__get_char(clekser) != del){
+		if (clekser->index >= clekser->buffer_size) return false;
+		clekser__consume(clekser);
+	}
+    return true;
+}
+
+CLEKS__PRIVATE bool Cleks__try_find_string(Clekser *clekser, char *del, size_t del_len)
+{
+    cleks__check(clekser != NULL && del != NULL, "Invalid argumens clekser:%p, del:%p", clekser, del);
+    if (del_len == 0) return true;
+    char stops[CLEKS__FIND_MAX];
+    size_t stop_count = Cleks__stop_bytes(clekser, del[0], stops);
+    while (!Cleks__starts_with_n(clekser, del, del_len)){
+        if (clekser->index >= clekser->buffer_size) return false;
+        bool comment_found = false;
+        if (!Cleks__try_skip_comments(clekser, &comment_found)) return false;
+        if (comment_found) continue;
+        clekser__consume(clekser);
+        if (stop_count > 0) Cleks__advance_to(clekser, Cleks__find_any(clekser->buffer, clekser->index, clekser->buffer_size, stops, stop_count));
+    }
+    return true;
+}
+
+CLEKS__PRIVATE bool Cleks__try_find_char(Clekser *clekser, char del)
+{
+    cleks__check(clekser != NULL, "Invalid arguments clekser:%p", clekser);
+    return Cleks__try_find_string(clekser, &del, 1);
+}
+
+// collect the bytes at which either `del` or a comment may start, returns 0 if there are too many to search for
+CLEKS__PRIVATE size_t Cleks__stop_bytes(Clekser *clekser, char del, char *stops)
+{
+    size_t count = 0;
+    stops[count++] = del;
+    for (size_t i=0; i<clekser->config->comment_count; ++i){
+        char c = clekser->config->comments[i].start_del[0];
+        if (c == '\0') return 0;
+        if (memchr(stops, c, count) != NULL) continue;
+        if (count == CLEKS__FIND_MAX) return 0;
+        stops[count++] = c;
+    }
+    return count;
+}
+
+// find the next occurence of any of `bytes` in buffer[index..size], returns `size` if there is none
+CLEKS__PRIVATE size_t Cleks__find_any(const char *buffer, size_t index, size_t size, const char *bytes, size_t count)
+{
+#if defined(__AVX2__)
+    __m256i needles[CLEKS__FIND_MAX];
+    for (size_t i=0; i<count; ++i) needles[i] = _mm256_set1_epi8(bytes[i]);
+    for (; index + 32 <= size; index += 32){
+        __m256i chunk = _mm256_loadu_si256((const __m256i*) (buffer + index));
+        __m256i hits = _mm256_cmpeq_epi8(chunk, needles[0]);
+        for (size_t i=1; i<count; ++i) hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, needles[i]));
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(hits);
+        if (mask != 0) return index + __builtin_ctz(mask);
+    }
+#elif defined(__SSE2__)
+    __m128i needles[CLEKS__FIND_MAX];
+    for (size_t i=0; i<count; ++i) needles[i] = _mm_set1_epi8(bytes[i]);
+    for (; index + 16 <= size; index += 16){
+        __m128i chunk = _mm_loadu_si128((const __m128i*) (buffer + index));
+        __m128i hits = _mm_cmpeq_epi8(chunk, needles[0]);
+        for (size_t i=1; i<count; ++i) hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, needles[i]));
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(hits);
+        if (mask != 0) return index + __builtin_ctz(mask);
+    }
+#endif
+    if (index >= size) return size;
+    if (count == 1){
+        const char *p = memchr(buffer + index, bytes[0], size - index);
+        return (p != NULL)? (size_t) (p - buffer) : size;
+    }
+    for (; index < size; ++index){
+        if (memchr(bytes, buffer[index], count) != NULL) return index;
+    }
+    return size;
+}
+
+// move the clekser forward to `index`, counting the skipped newlines in bulk
+CLEKS__PRIVATE void Cleks__advance_to(Clekser *clekser, size_t index)
+{
+    if (clekser->config->flags & CLEKS_FLAGS_LAZY_LOC){
+        clekser->index = index;
+        return;
+    }
+    const char *buffer = clekser->buffer;
+    size_t i = clekser->index;
+    size_t rows = 0;
+    size_t last_newline = SIZE_MAX;
+#if defined(__AVX2__)
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (; i + 32 <= index; i += 32){
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (buffer + i)), newline));
+        if (mask == 0) continue;
+        rows += __builtin_popcount(mask);
+        last_newline = i + 31 - __builtin_clz(mask);
+    }
+#elif defined(__SSE2__)
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= index; i += 16){
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (buffer + i)), newline));
+        if (mask == 0) continue;
+        rows += __builtin_popcount(mask);
+        last_newline = i + 31 - __builtin_clz(mask);
+    }
+#endif
+    for (; i < index; ++i){
+        if (buffer[i] != '\n') continue;
+        rows++;
+        last_newline = i;
+    }
+    if (last_newline != SIZE_MAX){
+        clekser->loc.row += rows;
+        clekser->loc.column = index - last_newline;
+    }
+    else{
+        clekser->loc.column += index - clekser->index;
+    }
+    clekser->index = index;
+}
+
+CLEKS__PRIVATE bool Cleks__try_skip_comments(Clekser *clekser, bool *result)
+{
+    CleksTokenIndex index = Cleks__match_comment(clekser);
+    if (index == CLEKS__NO_MATCH) return true;
+    if (!Cleks__skip_comment(clekser, index)) return false;
+    *result = true;
+    return true;
+}
+
+// skip the comment starting at the current position, with `index` into config.comments
+CLEKS__PRIVATE bool Cleks__skip_comment(Clekser *clekser, CleksTokenIndex index)
+{
+    CleksComment comment = clekser->config->comments[index];
+    const CleksCompiledConfig *compiled = clekser->compiled;
+    size_t end_len = (compiled != NULL)? compiled->comment_end_lens[index] : strlen(comment.end_del);
+    CleksLoc loc = clekser->loc;
+    char *p_start = clekser__get_pointer(clekser);
+    Cleks__skip_string(clekser, (compiled != NULL)? compiled->comment_start_lens[index] : strlen(comment.start_del));
+    if (!Cleks__find_string(clekser, comment.end_del, end_len)){
+        loc = Cleks__error_loc(clekser, loc, p_start);
+        Cleks__report(clekser, CLEKS_ERROR_UNTERMINATED_COMMENT, loc, p_start, "Expected \"%s\" for matching comment delimeter \"%s\" at %s:%d:%d!", comment.end_del, comment.start_del, CLEKS_LOC_EXPAND(loc));
+        return false;
+    }
+    Cleks__skip_string(clekser, end_len);
+    clekser__stat_add(clekser, comment_bytes, clekser__get_pointer(clekser) - p_start);
+    return true;
+}
+
+CLEKS__PRIVATE void Cleks__set_token(CleksToken *token, uint32_t type, uint32_t index, CleksLoc loc, char *start, char *end)
+{
+	cleks__check(token != NULL, "Invalid argument token:%p", token);
+	token->id = cleks_token_id(type, index);
+	token->loc = loc;
+	token->start = start;
+	token->end = end;
+	token->symbol = CLEKS_NO_SYMBOL;
+}
+
+CLEKS__PRIVATE bool Cleks__classify_word(Clekser *clekser, CleksToken *token, CleksLoc loc, char *start, char *end)
+{
+	CleksTokenIndex index = Cleks__match_word(clekser, start, end);
+	if (index != CLEKS__NO_MATCH){
+		Cleks__set_token(token, CLEKS_WORD, index, loc, start, end);
+		clekser__stat_token(clekser, CLEKS_WORD);
+		return true;
+	}
+	// no matching words found
+	uint8_t flags = clekser->config->flags;
+	CleksTokenType type = CLEKS_UNKNOWN;
+	if (flags & CLEKS_FLAGS_ALL_NUMS){
+		type = Cleks__scan_number(start, end);
+		clekser__stat_add(clekser, number_scans, 1);
+	}
+	// integers are floats as well, if only those are enabled
+	if (type == CLEKS_INTEGER && (flags & CLEKS_FLAGS_INTEGERS) == 0) type = CLEKS_FLOAT;
+	if ((type == CLEKS_INTEGER && (flags & CLEKS_FLAGS_INTEGERS)) || (type == CLEKS_FLOAT && (flags & CLEKS_FLAGS_FLOATS))
+		|| (type == CLEKS_HEX && (flags & CLEKS_FLAGS_HEX)) || (type == CLEKS_BIN && (flags & CLEKS_FLAGS_BIN))){
+		Cleks__set_token(token, type, 0, loc, start, end);
+		clekser__stat_token(clekser, type);
+		return true;
+	}
+	if ((clekser->config->flags & CLEKS_FLAGS_DISABLE_UNKNOWN) == 0){
+		Cleks__set_token(token, CLEKS_UNKNOWN, (clekser->config->flags & CLEKS_FLAGS_KEEP_UNKNOWN)? 1:0, loc, start, end);
+		clekser__stat_token(clekser, CLEKS_UNKNOWN);
+		return Cleks__intern_token(clekser, token);
+	}
+	loc = Cleks__error_loc(clekser, loc, start);
+	Cleks__report(clekser, CLEKS_ERROR_UNKNOWN_WORD, loc, start, "Unknown word found (flags: %d) at %s:%d:%d \"%.*s\"", clekser->config->flags, loc.filename, loc.row, loc.column, (int) (end-start), start);
+	return false;
+}
+
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_word(Clekser *clekser, char *start, char *end)
+{
+	size_t len = end - start;
+	const CleksCompiledConfig *compiled = clekser->compiled;
+	if (compiled != NULL){
+		size_t slot = Cleks__hash(start, len) & compiled->word_table_mask;
+		CleksTokenIndex i;
+		while ((i = compiled->word_table[slot]) != CLEKS__NO_MATCH){
+			clekser__stat_add(clekser, word_compares, 1);
+			if (compiled->word_lens[i] == len && memcmp(start, clekser->config->words[i], len) == 0) return i;
+			slot = (slot + 1) & compiled->word_table_mask;
+		}
+		return CLEKS__NO_MATCH;
+	}
+	for (size_t i=0; i<clekser->config->word_count; ++i){
+		clekser__stat_add(clekser, word_compares, 1);
+		if (strncmp(clekser->config->words[i], start, len) == 0 && clekser->config->words[i][len] == '\0') return i;
+	}
+	return CLEKS__NO_MATCH;
+}
+
+// 64-bit FNV-1a
+CLEKS__PRIVATE uint64_t Cleks__hash(const char *str, size_t len)
+{
+	uint64_t hash = 0xcbf29ce484222325;
+	for (size_t i=0; i<len; ++i){
+		hash ^= (uint8_t) str[i];
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+#define CLEKS__XXH_PRIME1 0x9E3779B185EBCA87ull
+#define CLEKS__XXH_PRIME2 0xC2B2AE3D27D4EB4Full
+#define CLEKS__XXH_PRIME3 0x165667B19E3779F9ull
+#define CLEKS__XXH_PRIME4 0x85EBCA77C2B2AE63ull
+#define CLEKS__XXH_PRIME5 0x27D4EB2F165667C5ull
+#define cleks__rotl64(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+#define cleks__xxh_round(acc, input) (cleks__rotl64((acc) + (input)*CLEKS__XXH_PRIME2, 31) * CLEKS__XXH_PRIME1)
+
+// XXH64 of whole buffers, reading 32 bytes per step instead of one as Cleks__hash does, the words are read in native byte order
+CLEKS__PRIVATE uint64_t Cleks__content_hash(const void *data, size_t len, uint64_t seed)
+{
+	const uint8_t *p = data;
+	const uint8_t *end = p + len;
+	uint64_t hash, word;
+	uint32_t half;
+	if (len >= 32){
+		uint64_t v[4] = {seed + CLEKS__XXH_PRIME1 + CLEKS__XXH_PRIME2, seed + CLEKS__XXH_PRIME2, seed, seed - CLEKS__XXH_PRIME1};
+		for (; p + 32 <= end; p += 32){
+			for (int i=0; i<4; ++i){
+				memcpy(&word, p + 8*i, sizeof(word));
+				v[i] = cleks__xxh_round(v[i], word);
+			}
+		}
+		hash = cleks__rotl64(v[0], 1) + cleks__rotl64(v[1], 7) + cleks__rotl64(v[2], 12) + cleks__rotl64(v[3], 18);
+		for (int i=0; i<4; ++i) hash = (hash ^ cleks__xxh_round(0, v[i])) * CLEKS__XXH_PRIME1 + CLEKS__XXH_PRIME4;
+	}
+	else hash = seed + CLEKS__XXH_PRIME5;
+	hash += len;
+	for (; p + 8 <= end; p += 8){
+		memcpy(&word, p, sizeof(word));
+		hash ^= cleks__xxh_round(0, word);
+		hash = cleks__rotl64(hash, 27) * CLEKS__XXH_PRIME1 + CLEKS__XXH_PRIME4;
+	}
+	if (p + 4 <= end){
+		memcpy(&half, p, sizeof(half));
+		hash ^= half * CLEKS__XXH_PRIME1;
+		hash = cleks__rotl64(hash, 23) * CLEKS__XXH_PRIME2 + CLEKS__XXH_PRIME3;
+		p += 4;
+	}
+	for (; p < end; ++p){
+		hash ^= *p * CLEKS__XXH_PRIME5;
+		hash = cleks__rotl64(hash, 11) * CLEKS__XXH_PRIME1;
+	}
+	hash ^= hash >> 33;
+	hash *= CLEKS__XXH_PRIME2;
+	hash ^= hash >> 29;
+	hash *= CLEKS__XXH_PRIME3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+CLEKS__PRIVATE bool Cleks__is_whitespace(Clekser *clekser, char c)
+{
+	cleks__check(clekser != NULL, "Invalid argument clekser:%p", clekser);
+	if (clekser->compiled != NULL) return clekser->compiled->classes[(uint8_t) c] & CLEKS__CLASS_WHITESPACE;
+	for (size_t i=0; i<clekser->config->whitespace_count; ++i){
+		if (clekser->config->whitespaces[i] == c) return true;
+	}
+	return false;
+}
+
+CLEKS__PRIVATE bool Cleks__is_symbol(Clekser *clekser, char c)
+{
+	cleks__check(clekser != NULL, "Invalid argument clekser:%p", clekser);
+	if (clekser->compiled != NULL) return clekser->compiled->classes[(uint8_t) c] & CLEKS__CLASS_SYMBOL;
+	for (size_t i=0; i<clekser->config->symbol_count; ++i){
+		if (c == clekser->config->symbols[i]) return true;
+	}
+	return false;
+}
+
+CLEKS__PRIVATE bool Cleks__is_word_end(Clekser *clekser)
+{
+	char c = clekser__get_char(clekser);
+	if (clekser->compiled != NULL){
+		uint8_t class = clekser->compiled->classes[(uint8_t) c];
+		if (class & CLEKS__CLASS_WORD_END) return true;
+		if ((class & (CLEKS__CLASS_COMMENT | CLEKS__CLASS_FIELD)) == 0) return false;
+		CleksTokenIndex comment, field;
+		Cleks__match_prefix(clekser, &comment, &field);
+		return comment != CLEKS__NO_MATCH || field != CLEKS__NO_MATCH;
+	}
+	if (Cleks__is_symbol(clekser, c) || Cleks__is_whitespace(clekser, c) || cleks__is_special(c)) return true;
+	return Cleks__match_string(clekser, c) != CLEKS__NO_MATCH
+		|| Cleks__match_comment(clekser) != CLEKS__NO_MATCH
+		|| Cleks__match_field(clekser) != CLEKS__NO_MATCH;
+}
+
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_symbol(Clekser *clekser, char c)
+{
+	const CleksCompiledConfig *compiled = clekser->compiled;
+	if (compiled != NULL){
+		return (compiled->classes[(uint8_t) c] & CLEKS__CLASS_SYMBOL)? compiled->symbol_index[(uint8_t) c] : CLEKS__NO_MATCH;
+	}
+	for (size_t i=0; i<clekser->config->symbol_count; ++i){
+		if (c == clekser->config->symbols[i]) return i;
+	}
+	return CLEKS__NO_MATCH;
+}
+
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_string(Clekser *clekser, char c)
+{
+	const CleksCompiledConfig *compiled = clekser->compiled;
+	if (compiled != NULL){
+		return (compiled->classes[(uint8_t) c] & CLEKS__CLASS_STRING)? compiled->string_index[(uint8_t) c] : CLEKS__NO_MATCH;
+	}
+	for (size_t i=0; i<clekser->config->string_count; ++i){
+		if (c == clekser->config->strings[i].start_del) return i;
+	}
+	return CLEKS__NO_MATCH;
+}
+
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_comment(Clekser *clekser)
+{
+	if (clekser->compiled != NULL){
+		CleksTokenIndex comment, field;
+		Cleks__match_prefix(clekser, &comment, &field);
+		return comment;
+	}
+	CleksTokenIndex match = CLEKS__NO_MATCH;
+	size_t match_len = 0;
+	for (size_t i=0; i<clekser->config->comment_count; ++i){
+		if (!Cleks__starts_with(clekser, clekser->config->comments[i].start_del)) continue;
+		if ((clekser->config->flags & CLEKS_FLAGS_LONGEST_MATCH) == 0) return i;
+		size_t len = strlen(clekser->config->comments[i].start_del);
+		if (match == CLEKS__NO_MATCH || len > match_len){
+			match = i;
+			match_len = len;
+		}
+	}
+	return match;
+}
+
+CLEKS__PRIVATE CleksTokenIndex Cleks__match_field(Clekser *clekser)
+{
+	if (clekser->compiled != NULL){
+		CleksTokenIndex comment, field;
+		Cleks__match_prefix(clekser, &comment, &field);
+		return field;
+	}
+	CleksTokenIndex match = CLEKS__NO_MATCH;
+	size_t match_len = 0;
+	for (size_t i=0; i<clekser->config->field_count; ++i){
+		if (!Cleks__starts_with(clekser, clekser->config->fields[i].prefix)) continue;
+		if ((clekser->config->flags & CLEKS_FLAGS_LONGEST_MATCH) == 0) return i;
+		size_t len = strlen(clekser->config->fields[i].prefix);
+		if (match == CLEKS__NO_MATCH || len > match_len){
+			match = i;
+			match_len = len;
+		}
+	}
+	return match;
+}
+
+// walk the prefix trie of a compiled config once, finding the comment and field matching at the current position
+CLEKS__PRIVATE void Cleks__match_prefix(Clekser *clekser, CleksTokenIndex *comment, CleksTokenIndex *field)
+{
+	const CleksCompiledConfig *compiled = clekser->compiled;
+	bool longest = clekser->config->flags & CLEKS_FLAGS_LONGEST_MATCH;
+	*comment = compiled->prefix_comment[0];
+	*field = compiled->prefix_field[0];
+	clekser__stat_add(clekser, prefix_probes, 1);
+	uint32_t node = 0;
+	for (size_t i=clekser->index; i<clekser->buffer_size; ++i){
+		node = compiled->prefix_next[node*compiled->prefix_alphabet_size + compiled->prefix_classes[(uint8_t) clekser->buffer[i]]];
+		if (node == 0) break;
+		// CLEKS__NO_MATCH is the largest index, so the first defined match wins by default
+		CleksTokenIndex index = compiled->prefix_comment[node];
+		if (index != CLEKS__NO_MATCH && (longest || index < *comment)) *comment = index;
+		index = compiled->prefix_field[node];
+		if (index != CLEKS__NO_MATCH && (longest || index < *field)) *field = index;
+	}
+}
+
+// the comment and field whose delimeters start at `index`, like Cleks__match_prefix but walking the prefix states of a CleksDfa
+CLEKS__PRIVATE void Cleks__dfa_match_prefix(Clekser *clekser, size_t index, CleksTokenIndex *comment, CleksTokenIndex *field)
+{
+	const CleksDfa *dfa = clekser->dfa;
+	bool longest = clekser->config->flags & CLEKS_FLAGS_LONGEST_MATCH;
+	*comment = dfa->prefix_comment[0];
+	*field = dfa->prefix_field[0];
+	clekser__stat_add(clekser, prefix_probes, 1);
+	uint32_t state = dfa->prefix_start;
+	for (size_t i=index; i<clekser->buffer_size; ++i){
+		state = dfa->next[state*dfa->class_count + dfa->classes[(uint8_t) clekser->buffer[i]]];
+		if (state == CLEKS__DFA_END) break;
+		CleksTokenIndex match = dfa->prefix_comment[state - dfa->prefix_start];
+		if (match != CLEKS__NO_MATCH && (longest || match < *comment)) *comment = match;
+		match = dfa->prefix_field[state - dfa->prefix_start];
+		if (match != CLEKS__NO_MATCH && (longest || match < *field)) *field = match;
+	}
+}
+
+// the token of a word, given the config word it equals and the literal Cleks__scan_number sees in it, like Cleks__classify_word
+CLEKS__PRIVATE CleksTokenID Cleks__dfa_accept(uint8_t flags, CleksTokenIndex word, CleksTokenType type)
+{
+	if (word != CLEKS__NO_MATCH) return cleks_token_id(CLEKS_WORD, word);
+	if (type == CLEKS_INTEGER && (flags & CLEKS_FLAGS_INTEGERS) == 0) type = CLEKS_FLOAT;
+	if ((type == CLEKS_INTEGER && (flags & CLEKS_FLAGS_INTEGERS)) || (type == CLEKS_FLOAT && (flags & CLEKS_FLAGS_FLOATS))
+		|| (type == CLEKS_HEX && (flags & CLEKS_FLAGS_HEX)) || (type == CLEKS_BIN && (flags & CLEKS_FLAGS_BIN))){
+		return cleks_token_id(type, 0);
+	}
+	if ((flags & CLEKS_FLAGS_DISABLE_UNKNOWN) == 0) return cleks_token_id(CLEKS_UNKNOWN, (flags & CLEKS_FLAGS_KEEP_UNKNOWN)? 1:0);
+	return CLEKS__DFA_REJECT;
+}
+
+CLEKS__PRIVATE uint32_t Cleks__prefix_insert(CleksCompiledConfig *compiled, const char *str)
+{
+	uint32_t node = 0;
+	for (; *str; ++str){
+		uint32_t *next = &compiled->prefix_next[node*compiled->prefix_alphabet_size + compiled->prefix_classes[(uint8_t) *str]];
+		if (*next == 0) *next = compiled->prefix_node_count++;
+		node = *next;
+	}
+	return node;
+}
+
+CLEKS__PRIVATE bool Cleks__starts_with(Clekser *clekser, char *str)
+{
+	cleks__check(clekser != NULL, "Invalid arguments clekser:%p, str:%p", clekser, str);
+	return Cleks__starts_with_n(clekser, str, strlen(str));
+}
+
+CLEKS__PRIVATE bool Cleks__starts_with_n(Clekser *clekser, char *str, size_t len)
+{
+	clekser__stat_add(clekser, prefix_probes, 1);
+	if (clekser->buffer_size - clekser->index < len) return false;
+	return memcmp(clekser->buffer + clekser->index, str, len) == 0;
+}
+
+// sort a literal into CLEKS_INTEGER, CLEKS_FLOAT, CLEKS_HEX or CLEKS_BIN in a single pass, CLEKS_UNKNOWN if it is none of them
+CLEKS__PRIVATE CleksTokenType Cleks__scan_number(const char *s, const char *e)
+{
+	if (e - s > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'b')){
+		bool hex = s[1] == 'x';
+		for (s += 2; s < e; ++s){
+			uint8_t c = (uint8_t) *s;
+			bool digit = hex? ((uint8_t) (c - '0') < 10 || (uint8_t) ((c | 0x20) - 'a') < 6) : (c == '0' || c == '1');
+			if (!digit) return CLEKS_UNKNOWN;
+		}
+		return hex? CLEKS_HEX : CLEKS_BIN;
+	}
+	if (s < e && (*s == '+' || *s == '-')) s++;
+	const char *digits = s;
+	while (e - s >= 8 && Cleks__is_eight_digits(s)) s += 8;
+	while (s < e && (uint8_t) (*s - '0') < 10) s++;
+	bool integral = s > digits;
+	if (s == e) return integral? CLEKS_INTEGER : CLEKS_UNKNOWN;
+	if (*s == '.'){
+		const char *fraction = ++s;
+		while (e - s >= 8 && Cleks__is_eight_digits(s)) s += 8;
+		while (s < e && (uint8_t) (*s - '0') < 10) s++;
+		if (!integral && s == fraction) return CLEKS_UNKNOWN;
+	}
+	else if (!integral) return Cleks__scan_special_float(s, e)? CLEKS_FLOAT : CLEKS_UNKNOWN;
+	if (s < e && (*s | 0x20) == 'e'){
+		if (++s < e && (*s == '+' || *s == '-')) s++;
+		const char *exponent = s;
+		while (s < e && (uint8_t) (*s - '0') < 10) s++;
+		if (s == exponent) return CLEKS_UNKNOWN;
+	}
+	return (s == e)? CLEKS_FLOAT : CLEKS_UNKNOWN;
+}
+
+// the transition of the automaton accepting the literals of Cleks__scan_number, one CLEKS__NUM_* state to the next
+CLEKS__PRIVATE uint8_t Cleks__number_step(uint8_t state, uint8_t c)
+{
+	bool digit = (uint8_t) (c - '0') < 10;
+	uint8_t lower = c | 0x20;
+	switch (state){
+		case CLEKS__NUM_START:
+			if (c == '0') return CLEKS__NUM_ZERO;
+			if (c == '+' || c == '-') return CLEKS__NUM_SIGN;
+			// fallthrough
+		case CLEKS__NUM_SIGN:
+			if (digit) return CLEKS__NUM_INT;
+			if (c == '.') return CLEKS__NUM_DOT;
+			if (lower == 'i') return CLEKS__NUM_INF;
+			return (lower == 'n')? CLEKS__NUM_NAN : 0;
+		case CLEKS__NUM_ZERO:
+			// only an unsigned literal can be hex or bin
+			if (c == 'x') return CLEKS__NUM_HEX_PREFIX;
+			if (c == 'b') return CLEKS__NUM_BIN_PREFIX;
+			// fallthrough
+		case CLEKS__NUM_INT:
+			if (digit) return CLEKS__NUM_INT;
+			if (c == '.') return CLEKS__NUM_FRACTION;
+			return (lower == 'e')? CLEKS__NUM_EXP : 0;
+		case CLEKS__NUM_DOT: return digit? CLEKS__NUM_FRACTION : 0;
+		case CLEKS__NUM_FRACTION:
+			if (digit) return CLEKS__NUM_FRACTION;
+			return (lower == 'e')? CLEKS__NUM_EXP : 0;
+		case CLEKS__NUM_EXP:
+			if (c == '+' || c == '-') return CLEKS__NUM_EXP_SIGN;
+			// fallthrough
+		case CLEKS__NUM_EXP_SIGN:
+		case CLEKS__NUM_EXP_DIGITS: return digit? CLEKS__NUM_EXP_DIGITS : 0;
+		case CLEKS__NUM_HEX_PREFIX:
+		case CLEKS__NUM_HEX: return (digit || (uint8_t) (lower - 'a') < 6)? CLEKS__NUM_HEX : 0;
+		case CLEKS__NUM_BIN_PREFIX:
+		case CLEKS__NUM_BIN: return (c == '0' || c == '1')? CLEKS__NUM_BIN : 0;
+		case CLEKS__NUM_NAN + 2: return (c == '(')? CLEKS__NUM_NAN_OPEN : 0;
+		case CLEKS__NUM_NAN_OPEN:
+			if (c == ')') return CLEKS__NUM_NAN_CLOSE;
+			return (cleks__is_alnum(c) || c == '_')? CLEKS__NUM_NAN_OPEN : 0;
+	}
+	if (state >= CLEKS__NUM_INF && state < CLEKS__NUM_INF + 7 && lower == "infinity"[state - CLEKS__NUM_INF + 1]) return state + 1;
+	if (state >= CLEKS__NUM_NAN && state < CLEKS__NUM_NAN + 2 && lower == "nan"[state - CLEKS__NUM_NAN + 1]) return state + 1;
+	return 0;
+}
+
+// the type Cleks__scan_number returns for a literal ending in `state`
+CLEKS__PRIVATE CleksTokenType Cleks__number_type(uint8_t state)
+{
+	switch (state){
+		case CLEKS__NUM_ZERO:
+		case CLEKS__NUM_INT: return CLEKS_INTEGER;
+		case CLEKS__NUM_FRACTION:
+		case CLEKS__NUM_EXP_DIGITS:
+		case CLEKS__NUM_INF + 2:
+		case CLEKS__NUM_INF + 7:
+		case CLEKS__NUM_NAN + 2:
+		case CLEKS__NUM_NAN_CLOSE: return CLEKS_FLOAT;
+		case CLEKS__NUM_HEX: return CLEKS_HEX;
+		case CLEKS__NUM_BIN: return CLEKS_BIN;
+		default: return CLEKS_UNKNOWN;
+	}
+}
+
+// "inf", "infinity", "nan" or "nan(...)" in any case, like strtod accepts them
+CLEKS__PRIVATE bool Cleks__scan_special_float(const char *s, const char *e)
+{
+	static const char *names[] = {"inf", "infinity", "nan"};
+	for (size_t i=0; i<CLEKS_ARR_LEN(names); ++i){
+		size_t len = strlen(names[i]);
+		if ((size_t) (e - s) < len) continue;
+		size_t j = 0;
+		while (j < len && (s[j] | 0x20) == names[i][j]) j++;
+		if (j < len) continue;
+		if (s + len == e) return true;
+		if (i != 2 || s[len] != '(' || e[-1] != ')') continue;
+		for (const char *c = s + len + 1; c < e - 1; ++c){
+			if (!cleks__is_alnum(*c) && *c != '_') return false;
+		}
+		return true;
+	}
+	return false;
+}
+
+// the value of an unsigned decimal, hex or bin literal, returns `false` on overflow
+CLEKS__PRIVATE bool Cleks__parse_u64(const char *s, const char *e, uint64_t *value)
+{
+	unsigned base = 10;
+	if (e - s > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'b')){
+		base = (s[1] == 'x')? 16 : 2;
+		s += 2;
+	}
+	uint64_t result = 0;
+	for (; s < e; ++s){
+		uint8_t c = (uint8_t) *s;
+		unsigned digit = ((uint8_t) (c - '0') < 10)? (unsigned) (c - '0') : (unsigned) ((c | 0x20) - 'a' + 10);
+		if (result > (UINT64_MAX - digit) / base) return false;
+		result = result*base + digit;
+	}
+	*value = result;
+	return true;
+}
+
+// the 128 most significant bits of 5^q for q in [-342, 308], rounded up for negative q
+static const uint64_t Cleks__powers_of_five[] = {
+	0xeef453d6923bd65a, 0x113faa2906a13b3f, 0x9558b4661b6565f8, 0x4ac7ca59a424c507,
+	0xbaaee17fa23ebf76, 0x5d79bcf00d2df649, 0xe95a99df8ace6f53, 0xf4d82c2c107973dc,
+	0x91d8a02bb6c10594, 0x79071b9b8a4be869, 0xb64ec836a47146f9, 0x9748e2826cdee284,
+	0xe3e27a444d8d98b7, 0xfd1b1b2308169b25, 0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7,
+	0xb208ef855c969f4f, 0xbdbd2d335e51a935, 0xde8b2b66b3bc4723, 0xad2c788035e61382,
+	0x8b16fb203055ac76, 0x4c3bcb5021afcc31, 0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d,
+	0xd953e8624b85dd78, 0xd71d6dad34a2af0d, 0x87d4713d6f33aa6b, 0x8672648c40e5ad68,
+	0xa9c98d8ccb009506, 0x680efdaf511f18c2, 0xd43bf0effdc0ba48, 0x0212bd1b2566def2,
+	0x84a57695fe98746d, 0x014bb630f7604b57, 0xa5ced43b7e3e9188, 0x419ea3bd35385e2d,
+	0xcf42894a5dce35ea, 0x52064cac828675b9, 0x818995ce7aa0e1b2, 0x7343efebd1940993,
+	0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8, 0xca66fa129f9b60a6, 0xd41a26e077774ef6,
+	0xfd00b897478238d0, 0x8920b098955522b4, 0x9e20735e8cb16382, 0x55b46e5f5d5535b0,
+	0xc5a890362fddbc62, 0xeb2189f734aa831d, 0xf712b443bbd52b7b, 0xa5e9ec7501d523e4,
+	0x9a6bb0aa55653b2d, 0x47b233c92125366e, 0xc1069cd4eabe89f8, 0x999ec0bb696e840a,
+	0xf148440a256e2c76, 0xc00670ea43ca250d, 0x96cd2a865764dbca, 0x380406926a5e5728,
+	0xbc807527ed3e12bc, 0xc605083704f5ecf2, 0xeba09271e88d976b, 0xf7864a44c633682e,
+	0x93445b8731587ea3, 0x7ab3ee6afbe0211d, 0xb8157268fdae9e4c, 0x5960ea05bad82964,
+	0xe61acf033d1a45df, 0x6fb92487298e33bd, 0x8fd0c16206306bab, 0xa5d3b6d479f8e056,
+	0xb3c4f1ba87bc8696, 0x8f48a4899877186c, 0xe0b62e2929aba83c, 0x331acdabfe94de87,
+	0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14, 0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9,
+	0xdb71e91432b1a24a, 0xc9e82cd9f69d6150, 0x892731ac9faf056e, 0xbe311c083a225cd2,
+	0xab70fe17c79ac6ca, 0x6dbd630a48aaf406, 0xd64d3d9db981787d, 0x092cbbccdad5b108,
+	0x85f0468293f0eb4e, 0x25bbf56008c58ea5, 0xa76c582338ed2621, 0xaf2af2b80af6f24e,
+	0xd1476e2c07286faa, 0x1af5af660db4aee1, 0x82cca4db847945ca, 0x50d98d9fc890ed4d,
+	0xa37fce126597973c, 0xe50ff107bab528a0, 0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8,
+	0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a, 0x9faacf3df73609b1, 0x77b191618c54e9ac,
+	0xc795830d75038c1d, 0xd59df5b9ef6a2417, 0xf97ae3d0d2446f25, 0x4b0573286b44ad1d,
+	0x9becce62836ac577, 0x4ee367f9430aec32, 0xc2e801fb244576d5, 0x229c41f793cda73f,
+	0xf3a20279ed56d48a, 0x6b43527578c1110f, 0x9845418c345644d6, 0x830a13896b78aaa9,
+	0xbe5691ef416bd60c, 0x23cc986bc656d553, 0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8,
+	0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9, 0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53,
+	0xe858ad248f5c22c9, 0xd1b3400f8f9cff68, 0x91376c36d99995be, 0x23100809b9c21fa1,
+	0xb58547448ffffb2d, 0xabd40a0c2832a78a, 0xe2e69915b3fff9f9, 0x16c90c8f323f516c,
+	0x8dd01fad907ffc3b, 0xae3da7d97f6792e3, 0xb1442798f49ffb4a, 0x99cd11cfdf41779c,
+	0xdd95317f31c7fa1d, 0x40405643d711d583, 0x8a7d3eef7f1cfc52, 0x482835ea666b2572,
+	0xad1c8eab5ee43b66, 0xda3243650005eecf, 0xd863b256369d4a40, 0x90bed43e40076a82,
+	0x873e4f75e2224e68, 0x5a7744a6e804a291, 0xa90de3535aaae202, 0x711515d0a205cb36,
+	0xd3515c2831559a83, 0x0d5a5b44ca873e03, 0x8412d9991ed58091, 0xe858790afe9486c2,
+	0xa5178fff668ae0b6, 0x626e974dbe39a872, 0xce5d73ff402d98e3, 0xfb0a3d212dc8128f,
+	0x80fa687f881c7f8e, 0x7ce66634bc9d0b99, 0xa139029f6a239f72, 0x1c1fffc1ebc44e80,
+	0xc987434744ac874e, 0xa327ffb266b56220, 0xfbe9141915d7a922, 0x4bf1ff9f0062baa8,
+	0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9, 0xc4ce17b399107c22, 0xcb550fb4384d21d3,
+	0xf6019da07f549b2b, 0x7e2a53a146606a48, 0x99c102844f94e0fb, 0x2eda7444cbfc426d,
+	0xc0314325637a1939, 0xfa911155fefb5308, 0xf03d93eebc589f88, 0x793555ab7eba27ca,
+	0x96267c7535b763b5, 0x4bc1558b2f3458de, 0xbbb01b9283253ca2, 0x9eb1aaedfb016f16,
+	0xea9c227723ee8bcb, 0x465e15a979c1cadc, 0x92a1958a7675175f, 0x0bfacd89ec191ec9,
+	0xb749faed14125d36, 0xcef980ec671f667b, 0xe51c79a85916f484, 0x82b7e12780e7401a,
+	0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810, 0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15,
+	0xdfbdcece67006ac9, 0x67a791e093e1d49a, 0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0,
+	0xaecc49914078536d, 0x58fae9f773886e18, 0xda7f5bf590966848, 0xaf39a475506a899e,
+	0x888f99797a5e012d, 0x6d8406c952429603, 0xaab37fd7d8f58178, 0xc8e5087ba6d33b83,
+	0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64, 0x855c3be0a17fcd26, 0x5cf2eea09a55067f,
+	0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e, 0xd0601d8efc57b08b, 0xf13b94daf124da26,
+	0x823c12795db6ce57, 0x76c53d08d6b70858, 0xa2cb1717b52481ed, 0x54768c4b0c64ca6e,
+	0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09, 0xfe5d54150b090b02, 0xd3f93b35435d7c4c,
+	0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf, 0xc6b8e9b0709f109a, 0x359ab6419ca1091b,
+	0xf867241c8cc6d4c0, 0xc30163d203c94b62, 0x9b407691d7fc44f8, 0x79e0de63425dcf1d,
+	0xc21094364dfb5636, 0x985915fc12f542e4, 0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d,
+	0x979cf3ca6cec5b5a, 0xa705992ceecf9c42, 0xbd8430bd08277231, 0x50c6ff782a838353,
+	0xece53cec4a314ebd, 0xa4f8bf5635246428, 0x940f4613ae5ed136, 0x871b7795e136be99,
+	0xb913179899f68584, 0x28e2557b59846e3f, 0xe757dd7ec07426e5, 0x331aeada2fe589cf,
+	0x9096ea6f3848984f, 0x3ff0d2c85def7621, 0xb4bca50b065abe63, 0x0fed077a756b53a9,
+	0xe1ebce4dc7f16dfb, 0xd3e8495912c62894, 0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c,
+	0xb080392cc4349dec, 0xbd8d794d96aacfb3, 0xdca04777f541c567, 0xecf0d7a0fc5583a0,
+	0x89e42caaf9491b60, 0xf41686c49db57244, 0xac5d37d5b79b6239, 0x311c2875c522ced5,
+	0xd77485cb25823ac7, 0x7d633293366b828b, 0x86a8d39ef77164bc, 0xae5dff9c02033197,
+	0xa8530886b54dbdeb, 0xd9f57f830283fdfc, 0xd267caa862a12d66, 0xd072df63c324fd7b,
+	0x8380dea93da4bc60, 0x4247cb9e59f71e6d, 0xa46116538d0deb78, 0x52d9be85f074e608,
+	0xcd795be870516656, 0x67902e276c921f8b, 0x806bd9714632dff6, 0x00ba1cd8a3db53b6,
+	0xa086cfcd97bf97f3, 0x80e8a40eccd228a4, 0xc8a883c0fdaf7df0, 0x6122cd128006b2cd,
+	0xfad2a4b13d1b5d6c, 0x796b805720085f81, 0x9cc3a6eec6311a63, 0xcbe3303674053bb0,
+	0xc3f490aa77bd60fc, 0xbedbfc4411068a9c, 0xf4f1b4d515acb93b, 0xee92fb5515482d44,
+	0x991711052d8bf3c5, 0x751bdd152d4d1c4a, 0xbf5cd54678eef0b6, 0xd262d45a78a0635d,
+	0xef340a98172aace4, 0x86fb897116c87c34, 0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0,
+	0xbae0a846d2195712, 0x8974836059cca109, 0xe998d258869facd7, 0x2bd1a438703fc94b,
+	0x91ff83775423cc06, 0x7b6306a34627ddcf, 0xb67f6455292cbf08, 0x1a3bc84c17b1d542,
+	0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93, 0x8e938662882af53e, 0x547eb47b7282ee9c,
+	0xb23867fb2a35b28d, 0xe99e619a4f23aa43, 0xdec681f9f4c31f31, 0x6405fa00e2ec94d4,
+	0x8b3c113c38f9f37e, 0xde83bc408dd3dd04, 0xae0b158b4738705e, 0x9624ab50b148d445,
+	0xd98ddaee19068c76, 0x3badd624dd9b0957, 0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6,
+	0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c, 0xd47487cc8470652b, 0x7647c3200069671f,
+	0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073, 0xa5fb0a17c777cf09, 0xf468107100525890,
+	0xcf79cc9db955c2cc, 0x7182148d4066eeb4, 0x81ac1fe293d599bf, 0xc6f14cd848405530,
+	0xa21727db38cb002f, 0xb8ada00e5a506a7c, 0xca9cf1d206fdc03b, 0xa6d90811f0e4851c,
+	0xfd442e4688bd304a, 0x908f4a166d1da663, 0x9e4a9cec15763e2e, 0x9a598e4e043287fe,
+	0xc5dd44271ad3cdba, 0x40eff1e1853f29fd, 0xf7549530e188c128, 0xd12bee59e68ef47c,
+	0x9a94dd3e8cf578b9, 0x82bb74f8301958ce, 0xc13a148e3032d6e7, 0xe36a52363c1faf01,
+	0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1, 0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9,
+	0xbcb2b812db11a5de, 0x7415d448f6b6f0e7, 0xebdf661791d60f56, 0x111b495b3464ad21,
+	0x936b9fcebb25c995, 0xcab10dd900beec34, 0xb84687c269ef3bfb, 0x3d5d514f40eea742,
+	0xe65829b3046b0afa, 0x0cb4a5a3112a5112, 0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab,
+	0xb3f4e093db73a093, 0x59ed216765690f56, 0xe0f218b8d25088b8, 0x306869c13ec3532c,
+	0x8c974f7383725573, 0x1e414218c73a13fb, 0xafbd2350644eeacf, 0xe5d1929ef90898fa,
+	0xdbac6c247d62a583, 0xdf45f746b74abf39, 0x894bc396ce5da772, 0x6b8bba8c328eb783,
+	0xab9eb47c81f5114f, 0x066ea92f3f326564, 0xd686619ba27255a2, 0xc80a537b0efefebd,
+	0x8613fd0145877585, 0xbd06742ce95f5f36, 0xa798fc4196e952e7, 0x2c48113823b73704,
+	0xd17f3b51fca3a7a0, 0xf75a15862ca504c5, 0x82ef85133de648c4, 0x9a984d73dbe722fb,
+	0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba, 0xcc963fee10b7d1b3, 0x318df905079926a8,
+	0xffbbcfe994e5c61f, 0xfdf17746497f7052, 0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633,
+	0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0, 0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0,
+	0x9c1661a651213e2d, 0x06bea10ca65c084e, 0xc31bfa0fe5698db8, 0x486e494fcff30a62,
+	0xf3e2f893dec3f126, 0x5a89dba3c3efccfa, 0x986ddb5c6b3a76b7, 0xf89629465a75e01c,
+	0xbe89523386091465, 0xf6bbb397f1135823, 0xee2ba6c0678b597f, 0x746aa07ded582e2c,
+	0x94db483840b717ef, 0xa8c2a44eb4571cdc, 0xba121a4650e4ddeb, 0x92f34d62616ce413,
+	0xe896a0d7e51e1566, 0x77b020baf9c81d17, 0x915e2486ef32cd60, 0x0ace1474dc1d122e,
+	0xb5b5ada8aaff80b8, 0x0d819992132456ba, 0xe3231912d5bf60e6, 0x10e1fff697ed6c69,
+	0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1, 0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2,
+	0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde, 0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b,
+	0xad4ab7112eb3929d, 0x86c16c98d2c953c6, 0xd89d64d57a607744, 0xe871c7bf077ba8b7,
+	0x87625f056c7c4a8b, 0x11471cd764ad4972, 0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf,
+	0xd389b47879823479, 0x4aff1d108d4ec2c3, 0x843610cb4bf160cb, 0xcedf722a585139ba,
+	0xa54394fe1eedb8fe, 0xc2974eb4ee658828, 0xce947a3da6a9273e, 0x733d226229feea32,
+	0x811ccc668829b887, 0x0806357d5a3f525f, 0xa163ff802a3426a8, 0xca07c2dcb0cf26f7,
+	0xc9bcff6034c13052, 0xfc89b393dd02f0b5, 0xfc2c3f3841f17c67, 0xbbac2078d443ace2,
+	0x9d9ba7832936edc0, 0xd54b944b84aa4c0d, 0xc5029163f384a931, 0x0a9e795e65d4df11,
+	0xf64335bcf065d37d, 0x4d4617b5ff4a16d5, 0x99ea0196163fa42e, 0x504bced1bf8e4e45,
+	0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6, 0xf07da27a82c37088, 0x5d767327bb4e5a4c,
+	0x964e858c91ba2655, 0x3a6a07f8d510f86f, 0xbbe226efb628afea, 0x890489f70a55368b,
+	0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e, 0x92c8ae6b464fc96f, 0x3b0b8bc90012929d,
+	0xb77ada0617e3bbcb, 0x09ce6ebb40173744, 0xe55990879ddcaabd, 0xcc420a6a101d0515,
+	0x8f57fa54c2a9eab6, 0x9fa946824a12232d, 0xb32df8e9f3546564, 0x47939822dc96abf9,
+	0xdff9772470297ebd, 0x59787e2b93bc56f7, 0x8bfbea76c619ef36, 0x57eb4edb3c55b65a,
+	0xaefae51477a06b03, 0xede622920b6b23f1, 0xdab99e59958885c4, 0xe95fab368e45eced,
+	0x88b402f7fd75539b, 0x11dbcb0218ebb414, 0xaae103b5fcd2a881, 0xd652bdc29f26a119,
+	0xd59944a37c0752a2, 0x4be76d3346f0495f, 0x857fcae62d8493a5, 0x6f70a4400c562ddb,
+	0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952, 0xd097ad07a71f26b2, 0x7e2000a41346a7a7,
+	0x825ecc24c873782f, 0x8ed400668c0c28c8, 0xa2f67f2dfa90563b, 0x728900802f0f32fa,
+	0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9, 0xfea126b7d78186bc, 0xe2f610c84987bfa8,
+	0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9, 0xc6ede63fa05d3143, 0x91503d1c79720dbb,
+	0xf8a95fcf88747d94, 0x75a44c6397ce912a, 0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba,
+	0xc24452da229b021b, 0xfbe85badce996168, 0xf2d56790ab41c2a2, 0xfae27299423fb9c3,
+	0x97c560ba6b0919a5, 0xdccd879fc967d41a, 0xbdb6b8e905cb600f, 0x5400e987bbc1c920,
+	0xed246723473e3813, 0x290123e9aab23b68, 0x9436c0760c86e30b, 0xf9a0b6720aaf6521,
+	0xb94470938fa89bce, 0xf808e40e8d5b3e69, 0xe7958cb87392c2c2, 0xb60b1d1230b20e04,
+	0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2, 0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3,
+	0xe2280b6c20dd5232, 0x25c6da63c38de1b0, 0x8d590723948a535f, 0x579c487e5a38ad0e,
+	0xb0af48ec79ace837, 0x2d835a9df0c6d851, 0xdcdb1b2798182244, 0xf8e431456cf88e65,
+	0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff, 0xac8b2d36eed2dac5, 0xe272467e3d222f3f,
+	0xd7adf884aa879177, 0x5b0ed81dcc6abb0f, 0x86ccbb52ea94baea, 0x98e947129fc2b4e9,
+	0xa87fea27a539e9a5, 0x3f2398d747b36224, 0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,
+	0x83a3eeeef9153e89, 0x1953cf68300424ac, 0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,
+	0xcdb02555653131b6, 0x3792f412cb06794d, 0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,
+	0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4, 0xc8de047564d20a8b, 0xf245825a5a445275,
+	0xfb158592be068d2e, 0xeed6e2f0f0d56712, 0x9ced737bb6c4183d, 0x55464dd69685606b,
+	0xc428d05aa4751e4c, 0xaa97e14c3c26b886, 0xf53304714d9265df, 0xd53dd99f4b3066a8,
+	0x993fe2c6d07b7fab, 0xe546a8038efe4029, 0xbf8fdb78849a5f96, 0xde98520472bdd033,
+	0xef73d256a5c0f77c, 0x963e66858f6d4440, 0x95a8637627989aad, 0xdde7001379a44aa8,
+	0xbb127c53b17ec159, 0x5560c018580d5d52, 0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,
+	0x9226712162ab070d, 0xcab3961304ca70e8, 0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,
+	0xe45c10c42a2b3b05, 0x8cb89a7db77c506a, 0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,
+	0xb267ed1940f1c61c, 0x55f038b237591ed3, 0xdf01e85f912e37a3, 0x6b6c46dec52f6688,
+	0x8b61313bbabce2c6, 0x2323ac4b3b3da015, 0xae397d8aa96c1b77, 0xabec975e0a0d081a,
+	0xd9c7dced53c72255, 0x96e7bd358c904a21, 0x881cea14545c7575, 0x7e50d64177da2e54,
+	0xaa242499697392d2, 0xdde50bd1d5d0b9e9, 0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,
+	0x84ec3c97da624ab4, 0xbd5af13bef0b113e, 0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,
+	0xcfb11ead453994ba, 0x67de18eda5814af2, 0x81ceb32c4b43fcf4, 0x80eacf948770ced7,
+	0xa2425ff75e14fc31, 0xa1258379a94d028d, 0xcad2f7f5359a3b3e, 0x096ee45813a04330,
+	0xfd87b5f28300ca0d, 0x8bca9d6e188853fc, 0x9e74d1b791e07e48, 0x775ea264cf55347e,
+	0xc612062576589dda, 0x95364afe032a819e, 0xf79687aed3eec551, 0x3a83ddbd83f52205,
+	0x9abe14cd44753b52, 0xc4926a9672793543, 0xc16d9a0095928a27, 0x75b7053c0f178294,
+	0xf1c90080baf72cb1, 0x5324c68b12dd6339, 0x971da05074da7bee, 0xd3f6fc16ebca5e04,
+	0xbce5086492111aea, 0x88f4bb1ca6bcf585, 0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,
+	0x9392ee8e921d5d07, 0x3aff322e62439fd0, 0xb877aa3236a4b449, 0x09befeb9fad487c3,
+	0xe69594bec44de15b, 0x4c2ebe687989a9b4, 0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,
+	0xb424dc35095cd80f, 0x538484c19ef38c95, 0xe12e13424bb40e13, 0x2865a5f206b06fba,
+	0x8cbccc096f5088cb, 0xf93f87b7442e45d4, 0xafebff0bcb24aafe, 0xf78f69a51539d749,
+	0xdbe6fecebdedd5be, 0xb573440e5a884d1c, 0x89705f4136b4a597, 0x31680a88f8953031,
+	0xabcc77118461cefc, 0xfdc20d2b36ba7c3e, 0xd6bf94d5e57a42bc, 0x3d32907604691b4d,
+	0x8637bd05af6c69b5, 0xa63f9a49c2c1b110, 0xa7c5ac471b478423, 0x0fcf80dc33721d54,
+	0xd1b71758e219652b, 0xd3c36113404ea4a9, 0x83126e978d4fdf3b, 0x645a1cac083126ea,
+	0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4, 0xcccccccccccccccc, 0xcccccccccccccccd,
+	0x8000000000000000, 0x0000000000000000, 0xa000000000000000, 0x0000000000000000,
+	0xc800000000000000, 0x0000000000000000, 0xfa00000000000000, 0x0000000000000000,
+	0x9c40000000000000, 0x0000000000000000, 0xc350000000000000, 0x0000000000000000,
+	0xf424000000000000, 0x0000000000000000, 0x9896800000000000, 0x0000000000000000,
+	0xbebc200000000000, 0x0000000000000000, 0xee6b280000000000, 0x0000000000000000,
+	0x9502f90000000000, 0x0000000000000000, 0xba43b74000000000, 0x0000000000000000,
+	0xe8d4a51000000000, 0x0000000000000000, 0x9184e72a00000000, 0x0000000000000000,
+	0xb5e620f480000000, 0x0000000000000000, 0xe35fa931a0000000, 0x0000000000000000,
+	0x8e1bc9bf04000000, 0x0000000000000000, 0xb1a2bc2ec5000000, 0x0000000000000000,
+	0xde0b6b3a76400000, 0x0000000000000000, 0x8ac7230489e80000, 0x0000000000000000,
+	0xad78ebc5ac620000, 0x0000000000000000, 0xd8d726b7177a8000, 0x0000000000000000,
+	0x878678326eac9000, 0x0000000000000000, 0xa968163f0a57b400, 0x0000000000000000,
+	0xd3c21bcecceda100, 0x0000000000000000, 0x84595161401484a0, 0x0000000000000000,
+	0xa56fa5b99019a5c8, 0x0000000000000000, 0xcecb8f27f4200f3a, 0x0000000000000000,
+	0x813f3978f8940984, 0x4000000000000000, 0xa18f07d736b90be5, 0x5000000000000000,
+	0xc9f2c9cd04674ede, 0xa400000000000000, 0xfc6f7c4045812296, 0x4d00000000000000,
+	0x9dc5ada82b70b59d, 0xf020000000000000, 0xc5371912364ce305, 0x6c28000000000000,
+	0xf684df56c3e01bc6, 0xc732000000000000, 0x9a130b963a6c115c, 0x3c7f400000000000,
+	0xc097ce7bc90715b3, 0x4b9f100000000000, 0xf0bdc21abb48db20, 0x1e86d40000000000,
+	0x96769950b50d88f4, 0x1314448000000000, 0xbc143fa4e250eb31, 0x17d955a000000000,
+	0xeb194f8e1ae525fd, 0x5dcfab0800000000, 0x92efd1b8d0cf37be, 0x5aa1cae500000000,
+	0xb7abc627050305ad, 0xf14a3d9e40000000, 0xe596b7b0c643c719, 0x6d9ccd05d0000000,
+	0x8f7e32ce7bea5c6f, 0xe4820023a2000000, 0xb35dbf821ae4f38b, 0xdda2802c8a800000,
+	0xe0352f62a19e306e, 0xd50b2037ad200000, 0x8c213d9da502de45, 0x4526f422cc340000,
+	0xaf298d050e4395d6, 0x9670b12b7f410000, 0xdaf3f04651d47b4c, 0x3c0cdd765f114000,
+	0x88d8762bf324cd0f, 0xa5880a69fb6ac800, 0xab0e93b6efee0053, 0x8eea0d047a457a00,
+	0xd5d238a4abe98068, 0x72a4904598d6d880, 0x85a36366eb71f041, 0x47a6da2b7f864750,
+	0xa70c3c40a64e6c51, 0x999090b65f67d924, 0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d,
+	0x82818f1281ed449f, 0xbff8f10e7a8921a4, 0xa321f2d7226895c7, 0xaff72d52192b6a0d,
+	0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490, 0xfee50b7025c36a08, 0x02f236d04753d5b4,
+	0x9f4f2726179a2245, 0x01d762422c946590, 0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5,
+	0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2, 0x9b934c3b330c8577, 0x63cc55f49f88eb2f,
+	0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb, 0xf316271c7fc3908a, 0x8bef464e3945ef7a,
+	0x97edd871cfda3a56, 0x97758bf0e3cbb5ac, 0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317,
+	0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd, 0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a,
+	0xb975d6b6ee39e436, 0xb3e2fd538e122b44, 0xe7d34c64a9c85d44, 0x60dbbca87196b616,
+	0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd, 0xb51d13aea4a488dd, 0x6babab6398bdbe41,
+	0xe264589a4dcdab14, 0xc696963c7eed2dd1, 0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2,
+	0xb0de65388cc8ada8, 0x3b25a55f43294bcb, 0xdd15fe86affad912, 0x49ef0eb713f39ebe,
+	0x8a2dbf142dfcc7ab, 0x6e3569326c784337, 0xacb92ed9397bf996, 0x49c2c37f07965404,
+	0xd7e77a8f87daf7fb, 0xdc33745ec97be906, 0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3,
+	0xa8acd7c0222311bc, 0xc40832ea0d68ce0c, 0xd2d80db02aabd62b, 0xf50a3fa490c30190,
+	0x83c7088e1aab65db, 0x792667c6da79e0fa, 0xa4b8cab1a1563f52, 0x577001b891185938,
+	0xcde6fd5e09abcf26, 0xed4c0226b55e6f86, 0x80b05e5ac60b6178, 0x544f8158315b05b4,
+	0xa0dc75f1778e39d6, 0x696361ae3db1c721, 0xc913936dd571c84c, 0x03bc3a19cd1e38e9,
+	0xfb5878494ace3a5f, 0x04ab48a04065c723, 0x9d174b2dcec0e47b, 0x62eb0d64283f9c76,
+	0xc45d1df942711d9a, 0x3ba5d0bd324f8394, 0xf5746577930d6500, 0xca8f44ec7ee36479,
+	0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb, 0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e,
+	0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e, 0x95d04aee3b80ece5, 0xbba1f1d158724a12,
+	0xbb445da9ca61281f, 0x2a8a6e45ae8edc97, 0xea1575143cf97226, 0xf52d09d71a3293bd,
+	0x924d692ca61be758, 0x593c2626705f9c56, 0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c,
+	0xe498f455c38b997a, 0x0b6dfb9c0f956447, 0x8edf98b59a373fec, 0x4724bd4189bd5eac,
+	0xb2977ee300c50fe7, 0x58edec91ec2cb657, 0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed,
+	0x8b865b215899f46c, 0xbd79e0d20082ee74, 0xae67f1e9aec07187, 0xecd8590680a3aa11,
+	0xda01ee641a708de9, 0xe80e6f4820cc9495, 0x884134fe908658b2, 0x3109058d147fdcdd,
+	0xaa51823e34a7eede, 0xbd4b46f0599fd415, 0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a,
+	0x850fadc09923329e, 0x03e2cf6bc604ddb0, 0xa6539930bf6bff45, 0x84db8346b786151c,
+	0xcfe87f7cef46ff16, 0xe612641865679a63, 0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e,
+	0xa26da3999aef7749, 0xe3be5e330f38f09d, 0xcb090c8001ab551c, 0x5cadf5bfd3072cc5,
+	0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6, 0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa,
+	0xc646d63501a1511d, 0xb281e1fd541501b8, 0xf7d88bc24209a565, 0x1f225a7ca91a4226,
+	0x9ae757596946075f, 0x3375788de9b06958, 0xc1a12d2fc3978937, 0x0052d6b1641c83ae,
+	0xf209787bb47d6b84, 0xc0678c5dbd23a49a, 0x9745eb4d50ce6332, 0xf840b7ba963646e0,
+	0xbd176620a501fbff, 0xb650e5a93bc3d898, 0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe,
+	0x93ba47c980e98cdf, 0xc66f336c36b10137, 0xb8a8d9bbe123f017, 0xb80b0047445d4184,
+	0xe6d3102ad96cec1d, 0xa60dc059157491e5, 0x9043ea1ac7e41392, 0x87c89837ad68db2f,
+	0xb454e4a179dd1877, 0x29babe4598c311fb, 0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a,
+	0x8ce2529e2734bb1d, 0x1899e4a65f58660c, 0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f,
+	0xdc21a1171d42645d, 0x76707543f4fa1f73, 0x899504ae72497eba, 0x6a06494a791c53a8,
+	0xabfa45da0edbde69, 0x0487db9d17636892, 0xd6f8d7509292d603, 0x45a9d2845d3c42b6,
+	0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2, 0xa7f26836f282b732, 0x8e6cac7768d7141e,
+	0xd1ef0244af2364ff, 0x3207d795430cd926, 0x8335616aed761f1f, 0x7f44e6bd49e807b8,
+	0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6, 0xcd036837130890a1, 0x36dba887c37a8c0f,
+	0x802221226be55a64, 0xc2494954da2c9789, 0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c,
+	0xc83553c5c8965d3d, 0x6f92829494e5acc7, 0xfa42a8b73abbf48c, 0xcb772339ba1f17f9,
+	0x9c69a97284b578d7, 0xff2a760414536efb, 0xc38413cf25e2d70d, 0xfef5138519684aba,
+	0xf46518c2ef5b8cd1, 0x7eb258665fc25d69, 0x98bf2f79d5993802, 0xef2f773ffbd97a61,
+	0xbeeefb584aff8603, 0xaafb550ffacfd8fa, 0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38,
+	0x952ab45cfa97a0b2, 0xdd945a747bf26183, 0xba756174393d88df, 0x94f971119aeef9e4,
+	0xe912b9d1478ceb17, 0x7a37cd5601aab85d, 0x91abb422ccb812ee, 0xac62e055c10ab33a,
+	0xb616a12b7fe617aa, 0x577b986b314d6009, 0xe39c49765fdf9d94, 0xed5a7e85fda0b80b,
+	0x8e41ade9fbebc27d, 0x14588f13be847307, 0xb1d219647ae6b31c, 0x596eb2d8ae258fc8,
+	0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb, 0x8aec23d680043bee, 0x25de7bb9480d5854,
+	0xada72ccc20054ae9, 0xaf561aa79a10ae6a, 0xd910f7ff28069da4, 0x1b2ba1518094da04,
+	0x87aa9aff79042286, 0x90fb44d2f05d0842, 0xa99541bf57452b28, 0x353a1607ac744a53,
+	0xd3fa922f2d1675f2, 0x42889b8997915ce8, 0x847c9b5d7c2e09b7, 0x69956135febada11,
+	0xa59bc234db398c25, 0x43fab9837e699095, 0xcf02b2c21207ef2e, 0x94f967e45e03f4bb,
+	0x8161afb94b44f57d, 0x1d1be0eebac278f5, 0xa1ba1ba79e1632dc, 0x6462d92a69731732,
+	0xca28a291859bbf93, 0x7d7b8f7503cfdcfe, 0xfcb2cb35e702af78, 0x5cda735244c3d43e,
+	0x9defbf01b061adab, 0x3a0888136afa64a7, 0xc56baec21c7a1916, 0x088aaa1845b8fdd0,
+	0xf6c69a72a3989f5b, 0x8aad549e57273d45, 0x9a3c2087a63f6399, 0x36ac54e2f678864b,
+	0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd, 0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5,
+	0x969eb7c47859e743, 0x9f644ae5a4b1b325, 0xbc4665b596706114, 0x873d5d9f0dde1fee,
+	0xeb57ff22fc0c7959, 0xa90cb506d155a7ea, 0x9316ff75dd87cbd8, 0x09a7f12442d588f2,
+	0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f, 0xe5d3ef282a242e81, 0x8f1668c8a86da5fa,
+	0x8fa475791a569d10, 0xf96e017d694487bc, 0xb38d92d760ec4455, 0x37c981dcc395a9ac,
+	0xe070f78d3927556a, 0x85bbe253f47b1417, 0x8c469ab843b89562, 0x93956d7478ccec8e,
+	0xaf58416654a6babb, 0x387ac8d1970027b2, 0xdb2e51bfe9d0696a, 0x06997b05fcc0319e,
+	0x88fcf317f22241e2, 0x441fece3bdf81f03, 0xab3c2fddeeaad25a, 0xd527e81cad7626c3,
+	0xd60b3bd56a5586f1, 0x8a71e223d8d3b074, 0x85c7056562757456, 0xf6872d5667844e49,
+	0xa738c6bebb12d16c, 0xb428f8ac016561db, 0xd106f86e69d785c7, 0xe13336d701beba52,
+	0x82a45b450226b39c, 0xecc0024661173473, 0xa34d721642b06084, 0x27f002d7f95d0190,
+	0xcc20ce9bd35c78a5, 0x31ec038df7b441f4, 0xff290242c83396ce, 0x7e67047175a15271,
+	0x9f79a169bd203e41, 0x0f0062c6e984d386, 0xc75809c42c684dd1, 0x52c07b78a3e60868,
+	0xf92e0c3537826145, 0xa7709a56ccdf8a82, 0x9bbcc7a142b17ccb, 0x88a66076400bb691,
+	0xc2abf989935ddbfe, 0x6acff893d00ea435, 0xf356f7ebf83552fe, 0x0583f6b8c4124d43,
+	0x98165af37b2153de, 0xc3727a337a8b704a, 0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c,
+	0xeda2ee1c7064130c, 0x1162def06f79df73, 0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8,
+	0xb9a74a0637ce2ee1, 0x6d953e2bd7173692, 0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437,
+	0x910ab1d4db9914a0, 0x1d9c9892400a22a2, 0xb54d5e4a127f59c8, 0x2503beb6d00cab4b,
+	0xe2a0b5dc971f303a, 0x2e44ae64840fd61d, 0x8da471a9de737e24, 0x5ceaecfed289e5d2,
+	0xb10d8e1456105dad, 0x7425a83e872c5f47, 0xdd50f1996b947518, 0xd12f124e28f77719,
+	0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f, 0xace73cbfdc0bfb7b, 0x636cc64d1001550b,
+	0xd8210befd30efa5a, 0x3c47f7e05401aa4e, 0x8714a775e3e95c78, 0x65acfaec34810a71,
+	0xa8d9d1535ce3b396, 0x7f1839a741a14d0d, 0xd31045a8341ca07c, 0x1ede48111209a050,
+	0x83ea2b892091e44d, 0x934aed0aab460432, 0xa4e4b66b68b65d60, 0xf81da84d5617853f,
+	0xce1de40642e3f4b9, 0x36251260ab9d668e, 0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019,
+	0xa1075a24e4421730, 0xb24cf65b8612f81f, 0xc94930ae1d529cfc, 0xdee033f26797b627,
+	0xfb9b7cd9a4a7443c, 0x169840ef017da3b1, 0x9d412e0806e88aa5, 0x8e1f289560ee864e,
+	0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2, 0xf5b5d7ec8acb58a2, 0xae10af696774b1db,
+	0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29, 0xbff610b0cc6edd3f, 0x17fd090a58d32af3,
+	0xeff394dcff8a948e, 0xddfc4b4cef07f5b0, 0x95f83d0a1fb69cd9, 0x4abdaf101564f98e,
+	0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1, 0xea53df5fd18d5513, 0x84c86189216dc5ed,
+	0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4, 0xb7118682dbb66a77, 0x3fbc8c33221dc2a1,
+	0xe4d5e82392a40515, 0x0fabaf3feaa5334a, 0x8f05b1163ba6832d, 0x29cb4d87f2a7400e,
+	0xb2c71d5bca9023f8, 0x743e20e9ef511012, 0xdf78e4b2bd342cf6, 0x914da9246b255416,
+	0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e, 0xae9672aba3d0c320, 0xa184ac2473b529b1,
+	0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e, 0x8865899617fb1871, 0x7e2fa67c7a658892,
+	0xaa7eebfb9df9de8d, 0xddbb901b98feeab7, 0xd51ea6fa85785631, 0x552a74227f3ea565,
+	0x8533285c936b35de, 0xd53a88958f87275f, 0xa67ff273b8460356, 0x8a892abaf368f137,
+	0xd01fef10a657842c, 0x2d2b7569b0432d85, 0x8213f56a67f6b29b, 0x9c3b29620e29fc73,
+	0xa298f2c501f45f42, 0x8349f3ba91b47b8f, 0xcb3f2f7642717713, 0x241c70a936219a73,
+	0xfe0efb53d30dd4d7, 0xed238cd383aa0110, 0x9ec95d1463e8a506, 0xf4363804324a40aa,
+	0xc67bb4597ce2ce48, 0xb143c6053edcd0d5, 0xf81aa16fdc1b81da, 0xdd94b7868e94050a,
+	0x9b10a4e5e9913128, 0xca7cf2b4191c8326, 0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0,
+	0xf24a01a73cf2dccf, 0xbc633b39673c8cec, 0x976e41088617ca01, 0xd5be0503e085d813,
+	0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18, 0xec9c459d51852ba2, 0xddf8e7d60ed1219e,
+	0x93e1ab8252f33b45, 0xcabb90e5c942b503, 0xb8da1662e7b00a17, 0x3d6a751f3b936243,
+	0xe7109bfba19c0c9d, 0x0cc512670a783ad4, 0x906a617d450187e2, 0x27fb2b80668b24c5,
+	0xb484f9dc9641e9da, 0xb1f9f660802dedf6, 0xe1a63853bbd26451, 0x5e7873f8a0396973,
+	0x8d07e33455637eb2, 0xdb0b487b6423e1e8, 0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62,
+	0xdc5c5301c56b75f7, 0x7641a140cc7810fb, 0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d,
+	0xac2820d9623bf429, 0x546345fa9fbdcd44, 0xd732290fbacaf133, 0xa97c177947ad4095,
+	0x867f59a9d4bed6c0, 0x49ed8eabcccc485d, 0xa81f301449ee8c70, 0x5c68f256bfff5a74,
+	0xd226fc195c6a2f8c, 0x73832eec6fff3111, 0x83585d8fd9c25db7, 0xc831fd53c5ff7eab,
+	0xa42e74f3d032f525, 0xba3e7ca8b77f5e55, 0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb,
+	0x80444b5e7aa7cf85, 0x7980d163cf5b81b3, 0xa0555e361951c366, 0xd7e105bcc332621f,
+	0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7, 0xfa856334878fc150, 0xb14f98f6f0feb951,
+	0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3, 0xc3b8358109e84f07, 0x0a862f80ec4700c8,
+	0xf4a642e14c6262c8, 0xcd27bb612758c0fa, 0x98e7e9cccfbd7dbd, 0x8038d51cb897789c,
+	0xbf21e44003acdd2c, 0xe0470a63e6bd56c3, 0xeeea5d5004981478, 0x1858ccfce06cac74,
+	0x95527a5202df0ccb, 0x0f37801e0c43ebc8, 0xbaa718e68396cffd, 0xd30560258f54e6ba,
+	0xe950df20247c83fd, 0x47c6b82ef32a2069, 0x91d28b7416cdd27e, 0x4cdc331d57fa5441,
+	0xb6472e511c81471d, 0xe0133fe4adf8e952, 0xe3d8f9e563a198e5, 0x58180fddd97723a6,
+	0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648,
+};
+
+// check 8 bytes for decimal digits at once
+CLEKS__PRIVATE bool Cleks__is_eight_digits(const char *s)
+{
+	uint64_t v;
+	memcpy(&v, s, sizeof(v));
+	return (((v & 0xF0F0F0F0F0F0F0F0) | (((v + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333);
+}
+
+// the value of 8 decimal digits, combining neighbouring digits in parallel
+CLEKS__PRIVATE uint32_t Cleks__parse_eight_digits(const char *s)
+{
+	uint64_t v;
+	memcpy(&v, s, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	v -= 0x3030303030303030;
+	v = 10*v + (v >> 8);
+	v = (((v & 0x000000FF000000FF) * 0x000F424000000064) + (((v >> 16) & 0x000000FF000000FF) * 0x0000271000000001)) >> 32;
+	return (uint32_t) v;
+}
+
+// the full 128 bit product of two 64 bit integers
+CLEKS__PRIVATE uint64_t Cleks__mul128(uint64_t a, uint64_t b, uint64_t *high)
+{
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 product = (unsigned __int128) a * b;
+	*high = product >> 64;
+	return (uint64_t) product;
+#else
+	uint64_t a_low = (uint32_t) a, a_high = a >> 32, b_low = (uint32_t) b, b_high = b >> 32;
+	uint64_t low = a_low*b_low, middle1 = a_high*b_low, middle2 = a_low*b_high;
+	uint64_t carry = (low >> 32) + (uint32_t) middle1 + (uint32_t) middle2;
+	*high = a_high*b_high + (middle1 >> 32) + (middle2 >> 32) + (carry >> 32);
+	return (carry << 32) | (uint32_t) low;
+#endif
+}
+
+// the nearest double to mantissa * 10^exponent using a 128 bit approximation of the power of ten (Eisel-Lemire),
+// which is exact for mantissas of up to 19 digits
+CLEKS__PRIVATE double Cleks__eisel_lemire(uint64_t mantissa, int64_t exponent)
+{
+	if (mantissa == 0 || exponent < -342) return 0.0;
+	if (exponent > 308) return INFINITY;
+#if defined(__GNUC__)
+	int leading_zeros = __builtin_clzll(mantissa);
+#else
+	int leading_zeros = 0;
+	while ((mantissa << leading_zeros >> 63) == 0) leading_zeros++;
+#endif
+	mantissa <<= leading_zeros;
+	const uint64_t *power = Cleks__powers_of_five + 2*(exponent + 342);
+	uint64_t high, low = Cleks__mul128(mantissa, power[0], &high);
+	// only the lower half of the power can still carry into the 55 bits needed
+	if ((high & 0x1FF) == 0x1FF){
+		uint64_t second_high;
+		Cleks__mul128(mantissa, power[1], &second_high);
+		low += second_high;
+		if (second_high > low) high++;
+	}
+	int upper_bit = high >> 63;
+	int shift = upper_bit + 9;
+	uint64_t bits = high >> shift;
+	// floor(log2(10^exponent)) + 63, minus the bias
+	int64_t binary_exponent = ((((152170 + 65536) * exponent) >> 16) + 63) + upper_bit - leading_zeros + 1023;
+	if (binary_exponent <= 0){
+		// subnormal
+		if (1 - binary_exponent >= 64) return 0.0;
+		bits >>= 1 - binary_exponent;
+		bits += bits & 1;
+		bits >>= 1;
+		binary_exponent = (bits < (1ull << 52))? 0 : 1;
+	}
+	else{
+		// exactly halfway, round to even instead of up
+		if (low <= 1 && exponent >= -4 && exponent <= 23 && (bits & 3) == 1 && (bits << shift) == high) bits &= ~1ull;
+		bits += bits & 1;
+		bits >>= 1;
+		if (bits >= (2ull << 52)){
+			bits = 1ull << 52;
+			binary_exponent++;
+		}
+		bits &= ~(1ull << 52);
+		if (binary_exponent >= 0x7FF) return INFINITY;
+	}
+	bits |= (uint64_t) binary_exponent << 52;
+	double result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+// round a decimal to the nearest double, the digits are scaled by powers of two until the mantissa is integral
+CLEKS__PRIVATE double Cleks__decimal_to_double(CleksDecimal *decimal, bool negative)
+{
+	// binary exponents which fit the first 9 decimal exponents
+	static const int powers[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+	const int max_power = CLEKS_ARR_LEN(powers);
+	uint64_t mantissa = 0;
+	int exponent = -1023;
+	if (decimal->count == 0 || decimal->point < -330) goto assemble;
+	if (decimal->point > 310) goto overflow;
+	exponent = 0;
+	// scale into [0.5, 1)
+	while (decimal->point > 0){
+		int n = (decimal->point >= max_power)? 27 : powers[decimal->point];
+		Cleks__decimal_shift(decimal, -n);
+		exponent += n;
+	}
+	while (decimal->point < 0 || (decimal->point == 0 && decimal->digits[0] < 5)){
+		int n = (-decimal->point >= max_power)? 27 : powers[-decimal->point];
+		Cleks__decimal_shift(decimal, n);
+		exponent -= n;
+	}
+	// doubles are normalized to [1, 2)
+	exponent--;
+	if (exponent < -1022){
+		// subnormal, shift the rest into the mantissa
+		Cleks__decimal_shift(decimal, -(-1022 - exponent));
+		exponent = -1022;
+	}
+	if (exponent > 1023) goto overflow;
+	Cleks__decimal_shift(decimal, 53);
+	mantissa = Cleks__decimal_round(decimal);
+	if (mantissa == (2ull << 52)){
+		// rounding carried into a new bit
+		mantissa >>= 1;
+		if (++exponent > 1023) goto overflow;
+	}
+	if ((mantissa & (1ull << 52)) == 0) exponent = -1023;
+	goto assemble;
+overflow:
+	mantissa = 0;
+	exponent = 1024;
+assemble:;
+	uint64_t bits = (mantissa & ((1ull << 52) - 1)) | ((uint64_t) (exponent + 1023) << 52) | ((uint64_t) negative << 63);
+	double result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+// multiply a decimal by 2^shift, shift being at most 60
+CLEKS__PRIVATE void Cleks__decimal_shift_left(CleksDecimal *decimal, unsigned shift)
+{
+	// every shift by up to 60 adds at most 19 digits
+	uint8_t digits[CLEKS__DECIMAL_DIGITS + 19];
+	int w = CLEKS_ARR_LEN(digits);
+	uint64_t n = 0;
+	for (int r=decimal->count-1; r>=0; --r){
+		n += (uint64_t) decimal->digits[r] << shift;
+		uint64_t quotient = n/10;
+		digits[--w] = n - 10*quotient;
+		n = quotient;
+	}
+	while (n > 0){
+		uint64_t quotient = n/10;
+		digits[--w] = n - 10*quotient;
+		n = quotient;
+	}
+	int count = CLEKS_ARR_LEN(digits) - w;
+	decimal->point += count - decimal->count;
+	if (count > CLEKS__DECIMAL_DIGITS){
+		for (int i=w+CLEKS__DECIMAL_DIGITS; i<(int) CLEKS_ARR_LEN(digits); ++i) decimal->truncated |= digits[i] != 0;
+		count = CLEKS__DECIMAL_DIGITS;
+	}
+	memcpy(decimal->digits, digits + w, count);
+	while (count > 0 && decimal->digits[count-1] == 0) count--;
+	decimal->count = count;
+	if (count == 0) decimal->point = 0;
+}
+
+// divide a decimal by 2^shift, shift being at most 60
+CLEKS__PRIVATE void Cleks__decimal_shift_right(CleksDecimal *decimal, unsigned shift)
+{
+	int r = 0, w = 0;
+	uint64_t n = 0;
+	// pick up enough leading digits to cover the first shift
+	for (; (n >> shift) == 0; ++r){
+		if (r >= decimal->count){
+			if (n == 0){
+				decimal->count = 0;
+				return;
+			}
+			while ((n >> shift) == 0){
+				n *= 10;
+				r++;
+			}
+			break;
+		}
+		n = 10*n + decimal->digits[r];
+	}
+	decimal->point -= r - 1;
+	uint64_t mask = (1ull << shift) - 1;
+	for (; r < decimal->count; ++r){
+		uint8_t digit = n >> shift;
+		n &= mask;
+		decimal->digits[w++] = digit;
+		n = 10*n + decimal->digits[r];
+	}
+	while (n > 0){
+		uint8_t digit = n >> shift;
+		n &= mask;
+		if (w < CLEKS__DECIMAL_DIGITS) decimal->digits[w++] = digit;
+		else if (digit > 0) decimal->truncated = true;
+		n *= 10;
+	}
+	while (w > 0 && decimal->digits[w-1] == 0) w--;
+	decimal->count = w;
+	if (w == 0) decimal->point = 0;
+}
+
+// multiply a decimal by 2^shift
+CLEKS__PRIVATE void Cleks__decimal_shift(CleksDecimal *decimal, int shift)
+{
+	if (decimal->count == 0) return;
+	for (; shift > 60; shift -= 60) Cleks__decimal_shift_left(decimal, 60);
+	for (; shift < -60; shift += 60) Cleks__decimal_shift_right(decimal, 60);
+	if (shift > 0) Cleks__decimal_shift_left(decimal, shift);
+	else if (shift < 0) Cleks__decimal_shift_right(decimal, -shift);
+}
+
+// the integral part of a decimal, rounded half to even
+CLEKS__PRIVATE uint64_t Cleks__decimal_round(CleksDecimal *decimal)
+{
+	if (decimal->point > 20) return UINT64_MAX;
+	int i = 0;
+	uint64_t n = 0;
+	for (; i < decimal->point && i < decimal->count; ++i) n = 10*n + decimal->digits[i];
+	for (; i < decimal->point; ++i) n *= 10;
+	int p = decimal->point;
+	if (p >= 0 && p < decimal->count){
+		bool up;
+		if (decimal->digits[p] == 5 && p+1 == decimal->count){
+			// exactly halfway, unless digits were dropped
+			up = decimal->truncated || (p > 0 && decimal->digits[p-1] % 2 != 0);
+		}
+		else up = decimal->digits[p] >= 5;
+		if (up) n++;
+	}
+	return n;
+}
+
+#ifdef CLEKS_THREADS
+
+// the speculative lexing result of one chunk of a buffer
+typedef struct CleksChunk{
+	Clekser clekser;           // positioned at the start of the chunk with a relative location
+	size_t start;              // the offset of the chunk
+	size_t end;                // the offset of the next chunk
+	CleksTokenBuffer tokens;   // tokens whose lexing started within the chunk
+	size_t *after;             // the clekser index after lexing each token
+	size_t exit;               // the first index at or after `end` a token would be lexed from
+	bool stopped;              // lexing failed or the buffer ended before `end`
+	bool out_of_memory;
+	CleksLoc end_loc;          // the relative location at `end`
+} CleksChunk;
+
+// a file of Cleks_lex_files
+typedef struct CleksFilesEntry{
+	size_t file;               // the position of its path
+	size_t size;               // the size before lexing, 0 if it could not be found
+	Clekser clekser;           // the clekser of a split file, which is opened before the threads start
+	CleksChunk *chunks;        // the chunks of a split file, NULL for a file lexed as a whole
+	size_t chunk_count;
+	size_t pending;            // the chunks not lexed yet, the thread lexing the last one stitches them together
+} CleksFilesEntry;
+
+// a job of Cleks_lex_files, either a batch of whole files or one chunk of a split file
+typedef struct{
+	size_t first;              // the first entry of the job
+	size_t count;              // the amount of entries, 0 for a chunk
+	size_t chunk;              // the chunk of entry `first`
+} CleksFilesJob;
+
+// the state the threads of Cleks_lex_files share
+typedef struct CleksFilesRun{
+	char **paths;
+	const CleksCompiledConfig *compiled;
+	CleksFileFn callback;
+	void *user;
+	CleksFilesEntry *entries;  // the files, largest first
+	CleksFilesJob *jobs;       // the chunks of the split files first, then the batches of whole files
+	size_t job_count;
+	pthread_mutex_t lock;      // guards the fields below and the `pending` counts of the entries
+	size_t next_job;           // the next job a thread takes
+	bool stopped;              // a callback returned `false`, so no further jobs are taken
+	CleksFilesStats stats;
+} CleksFilesRun;
+
+bool Cleks_tokenize_parallel(char *buffer, size_t buffer_size, const CleksConfig *config, size_t thread_count, CleksTokenBuffer *tokens, CleksError *error)
+{
+	cleks__require(buffer != NULL && config != NULL && tokens != NULL, false, "Invalid arguments buffer:%p, config:%p, tokens:%p", buffer, config, tokens);
+	if (thread_count == 0) thread_count = 1;
+	CleksCompiledConfig *compiled = Cleks_compile(config);
+	CleksChunk *chunks = calloc(thread_count, sizeof(*chunks));
+	pthread_t *threads = calloc(thread_count, sizeof(*threads));
+	Clekser clekser = {.error = {.kind = CLEKS_ERROR_MEMORY}};
+	bool success = compiled != NULL && chunks != NULL && threads != NULL;
+	if (!success) goto defer;
+
+	clekser = Cleks_create_compiled(buffer, buffer_size, compiled, NULL);
+	Cleks__parallel_split(&clekser, chunks, thread_count);
+	size_t started = 0;
+	for (; started<thread_count; ++started){
+		if (pthread_create(&threads[started], NULL, Cleks__parallel_worker, &chunks[started]) != 0) break;
+	}
+	// lex the chunks that did not get a thread on this one
+	for (size_t i=started; i<thread_count; ++i) Cleks__parallel_worker(&chunks[i]);
+	for (size_t i=0; i<started; ++i) pthread_join(threads[i], NULL);
+	if (!Cleks__parallel_stitch(&clekser, chunks, thread_count, tokens)) clekser.error = (CleksError) {.kind = CLEKS_ERROR_MEMORY};
+	success = clekser.error.kind == CLEKS_ERROR_NONE;
+
+defer:
+	if (error != NULL) *error = clekser.error;
+	Cleks__parallel_free(chunks, thread_count);
+	free(threads);
+	Cleks_destroy(&clekser);
+	Cleks_compiled_free(compiled);
+	return success;
+}
+
+// split the buffer of `clekser` into chunks at line starts, where a token is most likely to begin
+CLEKS__PRIVATE void Cleks__parallel_split(Clekser *clekser, CleksChunk *chunks, size_t chunk_count)
+{
+	char *buffer = clekser->buffer;
+	size_t buffer_size = clekser->buffer_size;
+	for (size_t i=0, start=0; i<chunk_count; ++i){
+		size_t end = buffer_size;
+		if (i+1 < chunk_count){
+			end = buffer_size/chunk_count*(i+1);
+			if (end < start) end = start;
+			char *newline = memchr(buffer + end, '\n', buffer_size - end);
+			end = (newline != NULL)? (size_t) (newline - buffer) + 1 : buffer_size;
+		}
+		chunks[i].start = start;
+		chunks[i].end = end;
+		chunks[i].clekser = Cleks_create_compiled(buffer, buffer_size, clekser->compiled, NULL);
+		chunks[i].clekser.index = start;
+		chunks[i].clekser.silent = true;
+		start = end;
+	}
+}
+
+// stitch the lexed chunks of the buffer of `clekser` together, starting each chunk where the previous one left off
+// the clekser ends up where a serial one would after the last token, returns `false` if memory ran out
+CLEKS__PRIVATE bool Cleks__parallel_stitch(Clekser *clekser, CleksChunk *chunks, size_t chunk_count, CleksTokenBuffer *tokens)
+{
+	for (size_t i=0; i<chunk_count; ++i){
+		if (chunks[i].out_of_memory) return false;
+	}
+	CleksLoc *bases = malloc(chunk_count * sizeof(*bases));
+	if (bases == NULL) return false;
+
+	// turn the relative chunk locations into absolute ones
+	bool lazy = clekser->config->flags & CLEKS_FLAGS_LAZY_LOC;
+	bases[0] = (CleksLoc) {lazy? 0 : 1, lazy? 0 : 1, clekser->loc.filename};
+	for (size_t i=0; i+1<chunk_count; ++i) bases[i+1] = lazy? bases[0] : Cleks__loc_join(bases[i], chunks[i].end_loc);
+
+	char *buffer = clekser->buffer;
+	size_t buffer_size = clekser->buffer_size;
+	bool success = true, stopped = false;
+	// lexes again where lexing stopped or the speculation went wrong
+	Clekser lexer = *clekser;
+	size_t index = 0, chunk = 0;
+	while (index < buffer_size){
+		while (index >= chunks[chunk].end) chunk++;
+		CleksChunk *c = &chunks[chunk];
+		// find the token lexed by the chunk right after `index`
+		size_t first = SIZE_MAX;
+		if (index == c->start) first = 0;
+		else{
+			size_t low = 0, high = c->tokens.count;
+			while (low < high){
+				size_t mid = low + (high - low)/2;
+				if (c->after[mid] < index) low = mid + 1;
+				else high = mid;
+			}
+			if (low < c->tokens.count && c->after[low] == index) first = low + 1;
+		}
+		if (first != SIZE_MAX){
+			if (!Cleks__token_buffer_reserve(tokens, tokens->count + c->tokens.count - first)){
+				success = false;
+				break;
+			}
+			for (size_t i=first; i<c->tokens.count; ++i){
+				size_t k = tokens->count++;
+				tokens->ids[k] = c->tokens.ids[i];
+				tokens->starts[k] = c->tokens.starts[i];
+				tokens->lengths[k] = c->tokens.lengths[i];
+				bool first_row = c->tokens.rows[i] == 1;
+				tokens->rows[k] = lazy? 0 : bases[chunk].row + c->tokens.rows[i] - 1;
+				tokens->columns[k] = lazy? 0 : first_row? bases[chunk].column + c->tokens.columns[i] - 1 : c->tokens.columns[i];
+				tokens->symbols[k] = c->tokens.symbols[i];
+			}
+			index = c->exit;
+			if (!c->stopped) continue;
+			// lexing failed or the buffer ended, repeat the last attempt to report its error
+			lexer.index = c->start;
+			lexer.loc = bases[chunk];
+			Cleks__advance_to(&lexer, index);
+			CleksToken token;
+			Cleks__lex(&lexer, &token);
+			stopped = true;
+			break;
+		}
+		// the speculation went wrong, lex the chunk again from `index`
+		lexer.index = c->start;
+		lexer.loc = bases[chunk];
+		Cleks__advance_to(&lexer, index);
+		CleksToken token;
+		while (lexer.index < c->end){
+			if (tokens->count == tokens->capacity && !Cleks__token_buffer_reserve(tokens, (tokens->capacity < 256)? 256 : 2*tokens->capacity)){
+				success = false;
+				break;
+			}
+			if (!Cleks__lex(&lexer, &token)){
+				stopped = true;
+				break;
+			}
+			Cleks__token_buffer_push(tokens, buffer, token);
+		}
+		if (!success || stopped) break;
+		index = lexer.index;
+	}
+
+	// keep a line index built to report an error
+	clekser->line_starts = lexer.line_starts;
+	clekser->line_count = lexer.line_count;
+	if (stopped){
+		clekser->index = lexer.index;
+		clekser->loc = lexer.loc;
+		clekser->error = lexer.error;
+	}
+	else if (success){
+		// every chunk was lexed up to its end, which the last one is the end of the buffer of
+		clekser->index = buffer_size;
+		if (!lazy) clekser->loc = Cleks__loc_join(bases[chunk_count-1], chunks[chunk_count-1].end_loc);
+		clekser->error.kind = CLEKS_ERROR_NONE;
+	}
+	free(bases);
+	return success;
+}
+
+// free the chunks of a buffer, along with their tokens and the line index a lazy chunk built for its error
+CLEKS__PRIVATE void Cleks__parallel_free(CleksChunk *chunks, size_t chunk_count)
+{
+	if (chunks == NULL) return;
+	for (size_t i=0; i<chunk_count; ++i){
+		Cleks_destroy(&chunks[i].clekser);
+		Cleks_token_buffer_free(&chunks[i].tokens);
+		free(chunks[i].after);
+	}
+	free(chunks);
+}
+
+// the location `rel`, counted from 1:1 by a lexer starting at `base`, within the whole buffer
+CLEKS__PRIVATE CleksLoc Cleks__loc_join(CleksLoc base, CleksLoc rel)
+{
+	if (rel.row == 1) return (CleksLoc) {base.row, base.column + rel.column - 1, base.filename};
+	return (CleksLoc) {base.row + rel.row - 1, rel.column, base.filename};
+}
+
+CLEKS__PRIVATE void* Cleks__parallel_worker(void *arg)
+{
+	CleksChunk *chunk = arg;
+	Clekser *clekser = &chunk->clekser;
+	CleksToken token;
+	while (clekser->index < chunk->end){
+		if (chunk->tokens.count == chunk->tokens.capacity){
+			size_t capacity = (chunk->tokens.capacity < 256)? 256 : 2*chunk->tokens.capacity;
+			size_t *after = realloc(chunk->after, capacity * sizeof(*after));
+			if (after != NULL) chunk->after = after;
+			if (after == NULL || !Cleks__token_buffer_reserve(&chunk->tokens, capacity)){
+				chunk->out_of_memory = true;
+				return NULL;
+			}
+		}
+		size_t index = clekser->index;
+		if (!Cleks__lex(clekser, &token)){
+			// remember where the failed attempt started
+			clekser->index = index;
+			chunk->stopped = true;
+			break;
+		}
+		chunk->after[chunk->tokens.count] = clekser->index;
+		Cleks__token_buffer_push(&chunk->tokens, clekser->buffer, token);
+	}
+	chunk->exit = clekser->index;
+	// the relative location at the end of the chunk, used to place the following chunks
+	static const CleksConfig counting = {0};
+	Clekser counter = Cleks_create(clekser->buffer, clekser->buffer_size, &counting, NULL);
+	counter.index = chunk->start;
+	Cleks__advance_to(&counter, chunk->end);
+	chunk->end_loc = counter.loc;
+	return NULL;
+}
+
+bool Cleks_pipeline_start(CleksPipeline *pipeline, Clekser *clekser, size_t capacity)
+{
+	cleks__require(pipeline != NULL && clekser != NULL && clekser->pipeline == NULL, false, "Invalid arguments pipeline:%p, clekser:%p", pipeline, clekser);
+	if (capacity == 0) capacity = CLEKS__PIPELINE_CAPACITY;
+	size_t slots = CLEKS__PIPELINE_BATCH;
+	while (slots < capacity) slots *= 2;
+	memset(pipeline, 0, sizeof(*pipeline));
+	pipeline->tokens = malloc(slots * sizeof(*pipeline->tokens));
+	pipeline->after = malloc(slots * sizeof(*pipeline->after));
+	if (pipeline->tokens == NULL || pipeline->after == NULL){
+		Cleks__report(clekser, CLEKS_ERROR_MEMORY, clekser->loc, NULL, "Could not allocate a pipeline of %zu tokens", slots);
+		free(pipeline->tokens);
+		free(pipeline->after);
+		return false;
+	}
+	pipeline->mask = slots - 1;
+	pipeline->clekser = clekser;
+	// the lexer continues after the peeked tokens, which the clekser still hands out first
+	pipeline->lexer = *clekser;
+	pipeline->lexer.line_starts = NULL;
+	pipeline->lexer.line_count = 0;
+	pipeline->lexer.buffer_owner = CLEKS__BUFFER_BORROWED;
+	pipeline->lexer.peeked = NULL;
+	pipeline->lexer.peek_count = 0;
+	pipeline->lexer.peek_failed = false;
+	if (pthread_create(&pipeline->thread, NULL, Cleks__pipeline_worker, pipeline) != 0){
+		Cleks__report(clekser, CLEKS_ERROR_MEMORY, clekser->loc, NULL, "Could not start the lexer thread");
+		free(pipeline->tokens);
+		free(pipeline->after);
+		return false;
+	}
+	// the clekser only pops from now on, which the batch functions must not bypass
+	clekser->pipeline = pipeline;
+	clekser->compiled = NULL;
+	clekser->dfa = NULL;
+	return true;
+}
+
+void Cleks_pipeline_stop(CleksPipeline *pipeline)
+{
+	cleks__require(pipeline != NULL && pipeline->clekser != NULL, , "Invalid argument pipeline:%p", pipeline);
+	cleks__store_release(&pipeline->stop, true);
+	pthread_join(pipeline->thread, NULL);
+	Clekser *clekser = pipeline->clekser;
+	Clekser *lexer = &pipeline->lexer;
+	clekser->pipeline = NULL;
+	clekser->compiled = lexer->compiled;
+	clekser->dfa = lexer->dfa;
+#ifdef CLEKS_STATS
+	clekser->stats = lexer->stats;
+#endif
+	if (pipeline->ended){
+		// the clekser ends up where a serial one would after lexing failed or the buffer ended
+		clekser->index = lexer->index;
+		clekser->loc = lexer->loc;
+	}
+	else if (pipeline->read > 0){
+		// strings are located at their start delimeter, every other token at its start
+		CleksToken *last = &pipeline->last;
+		clekser->index = last->start - clekser->buffer - (cleks_token_type(last->id) == CLEKS_STRING);
+		clekser->loc = last->loc;
+		Cleks__advance_to(clekser, pipeline->last_after);
+	}
+	// keep a line index the lexer thread built for its errors
+	if (clekser->line_starts == NULL){
+		clekser->line_starts = lexer->line_starts;
+		clekser->line_count = lexer->line_count;
+	}
+	else free(lexer->line_starts);
+	free(pipeline->tokens);
+	free(pipeline->after);
+	memset(pipeline, 0, sizeof(*pipeline));
+}
+
+// lex into the ring until the buffer ends, lexing fails or the pipeline is stopped
+CLEKS__PRIVATE void* Cleks__pipeline_worker(void *arg)
+{
+	CleksPipeline *pipeline = arg;
+	Clekser *lexer = &pipeline->lexer;
+	size_t capacity = pipeline->mask + 1;
+	size_t tail = 0, published = 0, head = 0;
+	while (true){
+		if (tail - head == capacity){
+			head = cleks__load_acquire(&pipeline->head);
+			if (tail - head == capacity){
+				// the consumer is behind, let it see everything before waiting for free slots
+				cleks__store_release(&pipeline->tail, tail);
+				published = tail;
+				unsigned spins = 0;
+				while (tail - (head = cleks__load_acquire(&pipeline->head)) == capacity){
+					if (cleks__load_acquire(&pipeline->stop)) goto done;
+					Cleks__pipeline_wait(&spins);
+				}
+			}
+		}
+		size_t slot = tail & pipeline->mask;
+		if (!Cleks__lex(lexer, &pipeline->tokens[slot])) break;
+		pipeline->after[slot] = lexer->index;
+		tail++;
+		if (tail - published == CLEKS__PIPELINE_BATCH){
+			cleks__store_release(&pipeline->tail, tail);
+			published = tail;
+			if (cleks__load_acquire(&pipeline->stop)) break;
+		}
+	}
+done:
+	// the tail has to be visible before `done`, so the consumer never misses the last tokens
+	cleks__store_release(&pipeline->tail, tail);
+	cleks__store_release(&pipeline->done, true);
+	return NULL;
+}
+
+// take the next token of the ring, waiting for the lexer thread if it is empty
+CLEKS__PRIVATE bool Cleks__pipeline_pop(Clekser *clekser, CleksToken *token)
+{
+	CleksPipeline *pipeline = clekser->pipeline;
+	if (pipeline->read == pipeline->limit){
+		// hand back the consumed slots before waiting for new ones
+		cleks__store_release(&pipeline->head, pipeline->read);
+		unsigned spins = 0;
+		while ((pipeline->limit = cleks__load_acquire(&pipeline->tail)) == pipeline->read){
+			if (cleks__load_acquire(&pipeline->done)){
+				pipeline->limit = cleks__load_acquire(&pipeline->tail);
+				if (pipeline->limit != pipeline->read) break;
+				clekser->error = pipeline->lexer.error;
+				pipeline->ended = true;
+				return false;
+			}
+			Cleks__pipeline_wait(&spins);
+		}
+	}
+	size_t slot = pipeline->read & pipeline->mask;
+	*token = pipeline->tokens[slot];
+	pipeline->last = *token;
+	pipeline->last_after = pipeline->after[slot];
+	pipeline->read++;
+	if ((pipeline->read & (CLEKS__PIPELINE_BATCH - 1)) == 0) cleks__store_release(&pipeline->head, pipeline->read);
+	return true;
+}
+
+// back off while the other side of a pipeline catches up: yield at first, then sleep, so a stalled side costs no core
+CLEKS__PRIVATE void Cleks__pipeline_wait(unsigned *spins)
+{
+	if ((*spins)++ < 64){
+		sched_yield();
+		return;
+	}
+	struct timespec pause = {0, 20000};
+	nanosleep(&pause, NULL);
+}
+
+bool Cleks_lex_files(char **paths, size_t path_count, const CleksConfig *config, size_t thread_count, CleksFileFn callback, void *user, CleksFilesStats *stats)
+{
+	cleks__require(config != NULL && (paths != NULL || path_count == 0), false, "Invalid arguments paths:%p, path_count:%zu, config:%p", paths, path_count, config);
+	if (thread_count == 0) thread_count = 1;
+	double start_time = Cleks__files_now();
+	CleksFilesRun run = {.paths = paths, .callback = callback, .user = user};
+	run.compiled = Cleks_compile(config);
+	// one more, so nothing is allocated with a size of 0
+	run.entries = calloc(path_count + 1, sizeof(*run.entries));
+	pthread_t *threads = calloc(thread_count, sizeof(*threads));
+	bool success = run.compiled != NULL && run.entries != NULL && threads != NULL;
+	if (!success) goto defer;
+
+	// the largest files first, so no thread is left with a large one while the others are done
+	for (size_t i=0; i<path_count; ++i) run.entries[i] = (CleksFilesEntry) {.file = i, .size = Cleks__file_size(paths[i])};
+	qsort(run.entries, path_count, sizeof(*run.entries), Cleks__files_compare);
+
+	// split large files into chunks, which are lexed and stitched together like those of Cleks_tokenize_parallel
+	size_t split = 0, chunk_total = 0;
+	while (thread_count > 1 && split < path_count && run.entries[split].size >= 2*CLEKS__FILES_CHUNK){
+		CleksFilesEntry *entry = &run.entries[split++];
+		if (!Cleks_create_from_file(&entry->clekser, paths[entry->file], &run.compiled->config)){
+			run.stats.failed++;
+			continue;
+		}
+		entry->clekser.compiled = run.compiled;
+		size_t chunk_count = entry->clekser.buffer_size/CLEKS__FILES_CHUNK;
+		if (chunk_count == 0) chunk_count = 1;
+		entry->chunks = calloc(chunk_count, sizeof(*entry->chunks));
+		if (entry->chunks == NULL){
+			Cleks_destroy(&entry->clekser);
+			success = false;
+			goto defer;
+		}
+		Cleks__parallel_split(&entry->clekser, entry->chunks, chunk_count);
+		entry->chunk_count = chunk_count;
+		entry->pending = chunk_count;
+		chunk_total += chunk_count;
+	}
+	run.jobs = malloc((chunk_total + path_count - split + 1) * sizeof(*run.jobs));
+	if (run.jobs == NULL){
+		success = false;
+		goto defer;
+	}
+	for (size_t i=0; i<split; ++i){
+		for (size_t c=0; c<run.entries[i].chunk_count; ++c) run.jobs[run.job_count++] = (CleksFilesJob) {.first = i, .count = 0, .chunk = c};
+	}
+	// batch the remaining files, so taking a job is rare compared to lexing it
+	for (size_t i=split; i<path_count;){
+		size_t first = i, bytes = 0;
+		while (i < path_count && i - first < CLEKS__FILES_BATCH_MAX && bytes < CLEKS__FILES_BATCH) bytes += run.entries[i++].size;
+		run.jobs[run.job_count++] = (CleksFilesJob) {.first = first, .count = i - first, .chunk = 0};
+	}
+
+	pthread_mutex_init(&run.lock, NULL);
+	// this thread is one of the workers
+	size_t started = 0;
+	for (; started+1<thread_count; ++started){
+		if (pthread_create(&threads[started], NULL, Cleks__files_worker, &run) != 0) break;
+	}
+	Cleks__files_worker(&run);
+	for (size_t i=0; i<started; ++i) pthread_join(threads[i], NULL);
+	pthread_mutex_destroy(&run.lock);
+	success = run.stats.failed == 0 && !run.stopped;
+
+defer:
+	if (run.entries != NULL){
+		// the split files a stopped run did not get to
+		for (size_t i=0; i<path_count; ++i){
+			if (run.entries[i].chunks == NULL) continue;
+			Cleks__parallel_free(run.entries[i].chunks, run.entries[i].chunk_count);
+			Cleks_destroy(&run.entries[i].clekser);
+		}
+	}
+	free(run.jobs);
+	free(run.entries);
+	free(threads);
+	Cleks_compiled_free(run.compiled);
+	run.stats.seconds = Cleks__files_now() - start_time;
+	if (stats != NULL) *stats = run.stats;
+	return success;
+}
+
+void Cleks_files_stats_dump(const CleksFilesStats *stats, FILE *file)
+{
+	cleks__require(stats != NULL && file != NULL, , "Invalid arguments stats:%p, file:%p", stats, file);
+	double seconds = (stats->seconds > 0)? stats->seconds : 1e-9;
+	fprintf(file, "files:   %zu lexed, %zu failed\n", stats->files, stats->failed);
+	fprintf(file, "bytes:   %zu\n", stats->bytes);
+	fprintf(file, "tokens:  %zu\n", stats->tokens);
+	fprintf(file, "time:    %.3f s\n", stats->seconds);
+	fprintf(file, "speed:   %.1f MB/s, %.2f M tokens/s\n", stats->bytes/seconds/1e6, stats->tokens/seconds/1e6);
+}
+
+// take jobs until there are none left or the run was stopped, then add what was lexed to the totals
+// seconds on a monotonic clock where there is one, so adjusting the wall clock does not skew a run
+CLEKS__PRIVATE double Cleks__files_now(void)
+{
+	struct timespec ts;
+#ifdef CLEKS__POSIX
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	timespec_get(&ts, TIME_UTC);
+#endif
+	return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+CLEKS__PRIVATE void* Cleks__files_worker(void *arg)
+{
+	CleksFilesRun *run = arg;
+	CleksFilesStats stats = {0};
+	CleksTokenBuffer tokens = {0};
+	while (true){
+		pthread_mutex_lock(&run->lock);
+		size_t next = run->next_job;
+		bool done = run->stopped || next == run->job_count;
+		if (!done) run->next_job++;
+		pthread_mutex_unlock(&run->lock);
+		if (done) break;
+		const CleksFilesJob *job = &run->jobs[next];
+		bool proceed = true;
+		if (job->count == 0) proceed = Cleks__files_chunk(run, &run->entries[job->first], job->chunk, &tokens, &stats);
+		for (size_t i=0; i<job->count && proceed; ++i) proceed = Cleks__files_lex(run, &run->entries[job->first + i], &tokens, &stats);
+		if (proceed) continue;
+		pthread_mutex_lock(&run->lock);
+		run->stopped = true;
+		pthread_mutex_unlock(&run->lock);
+		break;
+	}
+	pthread_mutex_lock(&run->lock);
+	run->stats.files += stats.files;
+	run->stats.failed += stats.failed;
+	run->stats.bytes += stats.bytes;
+	run->stats.tokens += stats.tokens;
+	pthread_mutex_unlock(&run->lock);
+	Cleks_token_buffer_free(&tokens);
+	return NULL;
+}
+
+// lex a whole file into the token buffer of a worker, returns `false` if the callback stopped the run
+CLEKS__PRIVATE bool Cleks__files_lex(CleksFilesRun *run, CleksFilesEntry *entry, CleksTokenBuffer *tokens, CleksFilesStats *stats)
+{
+	Clekser clekser;
+	if (!Cleks_create_from_file(&clekser, run->paths[entry->file], &run->compiled->config)){
+		stats->failed++;
+		return true;
+	}
+	clekser.compiled = run->compiled;
+	tokens->count = 0;
+	if (!Cleks_tokenize_all(&clekser, tokens)) Cleks__report(&clekser, CLEKS_ERROR_MEMORY, clekser.loc, NULL, "Could not store the tokens of '%s'", clekser.loc.filename);
+	bool proceed = Cleks__files_done(run, entry, &clekser, tokens, stats);
+	Cleks_destroy(&clekser);
+	return proceed;
+}
+
+// lex one chunk of a split file, stitching the file together if it was the last one, returns `false` if the callback stopped the run
+CLEKS__PRIVATE bool Cleks__files_chunk(CleksFilesRun *run, CleksFilesEntry *entry, size_t chunk, CleksTokenBuffer *tokens, CleksFilesStats *stats)
+{
+	Cleks__parallel_worker(&entry->chunks[chunk]);
+	pthread_mutex_lock(&run->lock);
+	bool last = --entry->pending == 0;
+	pthread_mutex_unlock(&run->lock);
+	if (!last) return true;
+	Clekser *clekser = &entry->clekser;
+	tokens->count = 0;
+	if (!Cleks__parallel_stitch(clekser, entry->chunks, entry->chunk_count, tokens)) Cleks__report(clekser, CLEKS_ERROR_MEMORY, clekser->loc, NULL, "Could not store the tokens of '%s'", clekser->loc.filename);
+	bool proceed = Cleks__files_done(run, entry, clekser, tokens, stats);
+	Cleks__parallel_free(entry->chunks, entry->chunk_count);
+	entry->chunks = NULL;
+	Cleks_destroy(clekser);
+	return proceed;
+}
+
+// count a lexed file and hand its tokens to the callback
+CLEKS__PRIVATE bool Cleks__files_done(CleksFilesRun *run, CleksFilesEntry *entry, const Clekser *clekser, const CleksTokenBuffer *tokens, CleksFilesStats *stats)
+{
+	if (clekser->error.kind == CLEKS_ERROR_NONE) stats->files++;
+	else stats->failed++;
+	stats->bytes += clekser->buffer_size;
+	stats->tokens += tokens->count;
+	return run->callback == NULL || run->callback(run->user, entry->file, clekser, tokens);
+}
+
+// the size of a file without opening it, 0 where it cannot be found
+CLEKS__PRIVATE size_t Cleks__file_size(const char *path)
+{
+#ifdef CLEKS__POSIX
+	struct stat st;
+	if (stat(path, &st) == 0 && st.st_size > 0) return st.st_size;
+#else
+	(void) path;
+#endif
+	return 0;
 }
 
+// orders the files of Cleks_lex_files by descending size, then by their position
+CLEKS__PRIVATE int Cleks__files_compare(const void *a, const void *b)
+{
+	const CleksFilesEntry *x = a, *y = b;
+	if (x->size != y->size) return (x->size < y->size)? 1 : -1;
+	return (x->file > y->file) - (x->file < y->file);
+}
+
+#endif // CLEKS_THREADS
+
 #endif // CLEKS_IMPLEMENTATION
\ No newline at end of file
@@ -0,0 +1,223 @@
+/*
+    examples.h
+    the example configs by name, and deterministic corpora for lexing them, shared by the tools, benchmarks and tests
+
+    example_fill stitches a corpus together from a config's own words, symbols, delimeters and number literals,
+    including broken ones, the benchmarks append their own records through example_put and friends.
+
+    Includes every example lexer, so it defines CLEKS_IMPLEMENTATION like they do.
+    A corpus only depends on its seed and what is appended to it, so it is identical on every platform and for every commit.
+*/
+
+#ifndef _CLEKS_EXAMPLES_H
+#define _CLEKS_EXAMPLES_H
+
+#include "json_lexer.h"
+#include "htm_lexer.h"
+#include "config_lexer.h"
+#include "txt_lexer.h"
+#include "xml_lexer.h"
+
+typedef struct{
+    const char *name;
+    CleksConfig *config;
+} ExampleTarget;
+
+typedef struct{
+    char *data;
+    size_t len;
+    size_t size;     // the target size of the corpus
+    uint64_t seed;   // state of the generator
+} ExampleCorpus;
+
+// the most bytes example_fragment appends
+#define EXAMPLE_FRAGMENT_MAX 256
+
+static ExampleTarget example_targets[] = {
+    {"JsonConfig", &JsonConfig},
+    {"html_config", &html_config},
+    {"config_config", &config_config},
+    {"txt_config", &txt_config},
+    {"xml_config", &xml_config},
+};
+
+// the example config called `name`, NULL if there is none
+static inline const ExampleTarget* example_find(const char *name)
+{
+    for (size_t t=0; t<CLEKS_ARR_LEN(example_targets); ++t){
+        if (strcmp(name, example_targets[t].name) == 0) return &example_targets[t];
+    }
+    return NULL;
+}
+
+// print the names of all example configs after `prefix`
+static inline void example_list(FILE *file, const char *prefix)
+{
+    fprintf(file, "%s", prefix);
+    for (size_t t=0; t<CLEKS_ARR_LEN(example_targets); ++t) fprintf(file, " %s", example_targets[t].name);
+    fprintf(file, "\n");
+}
+
+// an empty corpus of `size` bytes, with `slack` bytes of room for the last append beyond it
+static inline bool example_corpus(ExampleCorpus *corpus, size_t size, size_t slack, uint64_t seed)
+{
+    corpus->data = malloc(size + slack);
+    corpus->len = 0;
+    corpus->size = size;
+    corpus->seed = seed;
+    return corpus->data != NULL;
+}
+
+// xorshift64*, so the corpora are identical on every platform
+static inline uint32_t example_random(ExampleCorpus *corpus, uint32_t bound)
+{
+    corpus->seed ^= corpus->seed >> 12;
+    corpus->seed ^= corpus->seed << 25;
+    corpus->seed ^= corpus->seed >> 27;
+    return (uint32_t) ((corpus->seed * 2685821657736338717ull) >> 32) % bound;
+}
+
+static inline void example_put_n(ExampleCorpus *corpus, const char *str, size_t len)
+{
+    memcpy(corpus->data + corpus->len, str, len);
+    corpus->len += len;
+}
+
+static inline void example_put(ExampleCorpus *corpus, const char *str)
+{
+    example_put_n(corpus, str, strlen(str));
+}
+
+static inline void example_put_char(ExampleCorpus *corpus, char c)
+{
+    corpus->data[corpus->len++] = c;
+}
+
+static inline void example_put_uint(ExampleCorpus *corpus, uint32_t value)
+{
+    char digits[10];
+    size_t count = 0;
+    do{
+        digits[count++] = '0' + value%10;
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) corpus->data[corpus->len++] = digits[--count];
+}
+
+// a few bytes that may be anything, mostly letters
+static inline void example_put_text(ExampleCorpus *corpus)
+{
+    static const char text[] = "abcxyzABC_09.-+\\\"'<>/!*#\n\t ";
+    for (uint32_t i=0, n=example_random(corpus, 8); i<n; ++i){
+        uint32_t pick = example_random(corpus, 32);
+        if (pick < sizeof(text)-1) example_put_char(corpus, text[pick]);
+        else example_put_char(corpus, (char) example_random(corpus, 256));
+    }
+}
+
+// one piece of input hitting a part of the config, sometimes broken on purpose
+static inline void example_fragment(ExampleCorpus *corpus, const CleksConfig *config)
+{
+    static const char *numbers[] = {
+        "0", "42", "-7", "+3", "1.5", ".5", "5.", "1e10", "2.5E-3", "1e", "1e+", "0x1F", "0X", "-0xff", "0b101", "0b2",
+        "inf", "-infinity", "nan", "nan(12)", "nan(", "00", "1.2.3", "9999999999999999999999", "0x", "+", "-", "."
+    };
+    switch (example_random(corpus, 9)){
+        case 0:
+            if (config->word_count > 0){
+                const char *word = config->words[example_random(corpus, config->word_count)];
+                size_t len = strlen(word);
+                // the word itself, a prefix of it or a longer word starting with it
+                switch (example_random(corpus, 4)){
+                    case 0: example_put_n(corpus, word, (len > 1)? len-1 : len); break;
+                    case 1: example_put_n(corpus, word, len); example_put_char(corpus, 'x'); break;
+                    default: example_put_n(corpus, word, len);
+                }
+                break;
+            }
+            // fall through
+        case 1:
+            if (config->symbol_count > 0){
+                example_put_char(corpus, config->symbols[example_random(corpus, config->symbol_count)]);
+                break;
+            }
+            // fall through
+        case 2:
+            if (config->string_count > 0){
+                const CleksString *string = &config->strings[example_random(corpus, config->string_count)];
+                example_put_char(corpus, string->start_del);
+                example_put_text(corpus);
+                if (example_random(corpus, 4) == 0){
+                    example_put_char(corpus, '\\');
+                    example_put_char(corpus, string->end_del);
+                }
+                if (example_random(corpus, 16) != 0) example_put_char(corpus, string->end_del);
+                break;
+            }
+            // fall through
+        case 3:
+            if (config->comment_count > 0){
+                const CleksComment *comment = &config->comments[example_random(corpus, config->comment_count)];
+                example_put(corpus, comment->start_del);
+                example_put_text(corpus);
+                if (example_random(corpus, 16) != 0) example_put(corpus, comment->end_del);
+                break;
+            }
+            // fall through
+        case 4:
+            if (config->field_count > 0){
+                const CleksField *field = &config->fields[example_random(corpus, config->field_count)];
+                example_put(corpus, field->prefix);
+                example_put_text(corpus);
+                if (example_random(corpus, 16) != 0) example_put(corpus, field->suffix);
+                break;
+            }
+            // fall through
+        case 5:
+        case 6:{
+            const char *number = numbers[example_random(corpus, CLEKS_ARR_LEN(numbers))];
+            example_put(corpus, number);
+            break;
+        }
+        case 7:
+            if (config->whitespace_count > 0){
+                example_put_char(corpus, config->whitespaces[example_random(corpus, config->whitespace_count)]);
+                break;
+            }
+            // fall through
+        default: example_put_text(corpus);
+    }
+    // fragments are glued together half of the time, so word ends are tested as well
+    if (config->whitespace_count > 0 && example_random(corpus, 2) == 0) example_put_char(corpus, config->whitespaces[0]);
+}
+
+// a corpus of at least `size` bytes stitched together from fragments of `config`
+static inline bool example_fill(ExampleCorpus *corpus, const CleksConfig *config, size_t size, uint64_t seed)
+{
+    if (!example_corpus(corpus, size, EXAMPLE_FRAGMENT_MAX, seed*0x9E3779B97F4A7C15ull + 1)) return false;
+    while (corpus->len < corpus->size) example_fragment(corpus, config);
+    return true;
+}
+
+// whether `c` separates the fragments of a corpus
+static inline bool example_is_space(const CleksConfig *config, char c)
+{
+    for (size_t i=0; i<config->whitespace_count; ++i){
+        if (config->whitespaces[i] == c) return true;
+    }
+    return c == '\n';
+}
+
+// blank the fragment around `offset`, or at least the byte at it, so lexing gets past an error there, returns the edit
+static inline CleksEdit example_blank(ExampleCorpus *corpus, const CleksConfig *config, size_t offset)
+{
+    if (offset >= corpus->len) return (CleksEdit) {corpus->len, 0, 0};
+    char blank = (config->whitespace_count > 0)? config->whitespaces[0] : ' ';
+    size_t start = offset, end = offset + 1;
+    while (start > 0 && !example_is_space(config, corpus->data[start-1])) start--;
+    while (end < corpus->len && !example_is_space(config, corpus->data[end])) end++;
+    memset(corpus->data + start, blank, end - start);
+    return (CleksEdit) {start, end - start, end - start};
+}
+
+#endif // _CLEKS_EXAMPLES_H
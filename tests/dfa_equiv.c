@@ -0,0 +1,84 @@
+/*
+    dfa_equiv.c
+    checks that a Clekser lexing with a CleksDfa returns the same tokens as one lexing with the lookup tables
+
+    build: cc -O2 -o dfa_equiv tests/dfa_equiv.c
+    run:   ./dfa_equiv [file ...]
+
+    Every example config is tried with each of the 256 combinations of the CLEKS_FLAGS_* bits, on deterministic corpora
+    stitched together from the config's own words, symbols, delimeters and number literals (including unterminated ones)
+    as well as on every given file. The tokens, their locations, the final position and the error have to match.
+    Exits with 1 at the first difference.
+*/
+
+#include "../examples/examples.h"
+
+// the amount of corpora per config and the size of each one
+#define EQUIV_CORPORA 8
+#define EQUIV_CORPUS_SIZE (8*1024)
+
+// lex a buffer with both engines, returns the amount of tokens or SIZE_MAX if they differ
+static size_t equiv_compare(char *buffer, size_t buffer_size, const CleksCompiledConfig *compiled, const CleksDfa *dfa, const char *name)
+{
+    Clekser tables = Cleks_create_compiled(buffer, buffer_size, compiled, NULL);
+    Clekser automaton = Cleks_create_compiled(buffer, buffer_size, compiled, NULL);
+    Cleks_use_dfa(&automaton, dfa);
+    tables.silent = automaton.silent = true;
+    CleksToken a, b;
+    size_t count = 0;
+    bool same = true;
+    while (same){
+        bool lexed = Cleks_next(&tables, &a);
+        same = lexed == Cleks_next(&automaton, &b);
+        if (!same || !lexed) break;
+        same = a.id == b.id && a.start == b.start && a.end == b.end && a.loc.row == b.loc.row && a.loc.column == b.loc.column;
+        if (same) count++;
+    }
+    same = same && tables.index == automaton.index && tables.loc.row == automaton.loc.row && tables.loc.column == automaton.loc.column
+        && tables.error.kind == automaton.error.kind && tables.error.offset == automaton.error.offset
+        && tables.error.loc.row == automaton.error.loc.row && tables.error.loc.column == automaton.error.loc.column;
+    if (!same){
+        fprintf(stderr, "%s, flags 0x%02x: the engines differ after %zu tokens, at offsets %zu and %zu (errors %d and %d)\n",
+            name, compiled->config.flags, count, tables.index, automaton.index, tables.error.kind, automaton.error.kind);
+    }
+    Cleks_destroy(&tables);
+    Cleks_destroy(&automaton);
+    return same? count : SIZE_MAX;
+}
+
+int main(int argc, char **argv)
+{
+    Clekser files[argc > 1? argc-1 : 1];
+    for (int i=1; i<argc; ++i){
+        if (!Cleks_create_from_file(&files[i-1], argv[i], example_targets[0].config)) return 1;
+    }
+    bool result = true;
+    for (size_t t=0; t<CLEKS_ARR_LEN(example_targets) && result; ++t){
+        ExampleCorpus corpora[EQUIV_CORPORA] = {0};
+        for (size_t c=0; c<EQUIV_CORPORA && result; ++c) result = example_fill(&corpora[c], example_targets[t].config, EQUIV_CORPUS_SIZE, c);
+        size_t token_count = 0, skipped = 0;
+        for (unsigned flags=0; flags<256 && result; ++flags){
+            CleksConfig config = *example_targets[t].config;
+            config.flags = flags;
+            CleksCompiledConfig *compiled = Cleks_compile(&config);
+            CleksDfa *dfa = (compiled != NULL)? Cleks_compile_dfa(compiled) : NULL;
+            if (dfa == NULL) skipped++;
+            for (size_t c=0; c<EQUIV_CORPORA && dfa != NULL && result; ++c){
+                size_t count = equiv_compare(corpora[c].data, corpora[c].len, compiled, dfa, example_targets[t].name);
+                result = count != SIZE_MAX;
+                token_count += count;
+            }
+            for (int f=0; f+1<argc && dfa != NULL && result; ++f){
+                size_t count = equiv_compare(files[f].buffer, files[f].buffer_size, compiled, dfa, example_targets[t].name);
+                result = count != SIZE_MAX;
+                token_count += count;
+            }
+            Cleks_dfa_free(dfa);
+            Cleks_compiled_free(compiled);
+        }
+        for (size_t c=0; c<EQUIV_CORPORA; ++c) free(corpora[c].data);
+        if (result) printf("%-14s %zu tokens identical, %zu flag combinations without an automaton\n", example_targets[t].name, token_count, skipped);
+    }
+    for (int i=1; i<argc; ++i) Cleks_destroy(&files[i-1]);
+    return result? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/*
+    gen_equiv.c
+    checks that the lexers tools/cleks_gen.c generates for the example configs return the same tokens as Cleks_next
+
+    build: cc -O2 -o cleks_gen tools/cleks_gen.c && mkdir -p gen
+           for c in JsonConfig html_config config_config txt_config xml_config; do ./cleks_gen -o gen -i ../cleks2.h $c gen_$c; done
+           cc -O2 -Igen -o gen_equiv tests/gen_equiv.c
+    run:   ./gen_equiv [file ...]
+
+    Every generated lexer is compared with a Clekser lexing with the same config, on deterministic corpora stitched
+    together from the config's own words, symbols, delimeters and number literals (including unterminated ones) and on
+    the same corpora with their errors blanked out, as well as on every given file. The tokens, their locations, the
+    final position and the error have to match. Exits with 1 at the first difference.
+*/
+
+#include "../examples/examples.h"
+#include "gen_JsonConfig.c"
+#include "gen_html_config.c"
+#include "gen_config_config.c"
+#include "gen_txt_config.c"
+#include "gen_xml_config.c"
+
+// the amount of corpora per config, the size of each one and the most times the errors of a corpus are blanked out
+#define GEN_CORPORA 8
+#define GEN_CORPUS_SIZE (8*1024)
+#define GEN_REPAIRS 4096
+
+typedef bool (*GenNextFn)(Clekser *clekser, CleksToken *token);
+
+typedef struct{
+    const char *config;
+    GenNextFn next;
+} GenLexer;
+
+static const GenLexer gen_lexers[] = {
+    {"JsonConfig", gen_JsonConfig_next},
+    {"html_config", gen_html_config_next},
+    {"config_config", gen_config_config_next},
+    {"txt_config", gen_txt_config_next},
+    {"xml_config", gen_xml_config_next},
+};
+
+// lex a buffer with Cleks_next and the generated lexer, returns the amount of tokens or SIZE_MAX if they differ
+// `offset` is set to where the error is, or to the buffer size if there is none
+static size_t gen_compare(char *buffer, size_t buffer_size, const CleksConfig *config, GenNextFn next, const char *name, size_t *offset)
+{
+    Clekser library = Cleks_create(buffer, buffer_size, config, NULL);
+    Clekser generated = Cleks_create(buffer, buffer_size, config, NULL);
+    library.silent = generated.silent = true;
+    CleksToken a, b;
+    size_t count = 0;
+    bool same = true;
+    while (same){
+        bool lexed = Cleks_next(&library, &a);
+        same = lexed == next(&generated, &b);
+        if (!same || !lexed) break;
+        same = a.id == b.id && a.start == b.start && a.end == b.end && a.loc.row == b.loc.row && a.loc.column == b.loc.column;
+        if (same) count++;
+    }
+    same = same && library.index == generated.index && library.loc.row == generated.loc.row && library.loc.column == generated.loc.column
+        && library.error.kind == generated.error.kind && library.error.offset == generated.error.offset
+        && library.error.loc.row == generated.error.loc.row && library.error.loc.column == generated.error.loc.column;
+    if (!same){
+        fprintf(stderr, "%s: the lexers differ after %zu tokens, at offsets %zu and %zu (errors %d and %d)\n",
+            name, count, library.index, generated.index, library.error.kind, generated.error.kind);
+    }
+    *offset = (library.error.kind != CLEKS_ERROR_NONE)? library.error.offset : buffer_size;
+    Cleks_destroy(&library);
+    Cleks_destroy(&generated);
+    return same? count : SIZE_MAX;
+}
+
+int main(int argc, char **argv)
+{
+    Clekser files[argc > 1? argc-1 : 1];
+    for (int i=1; i<argc; ++i){
+        if (!Cleks_create_from_file(&files[i-1], argv[i], example_targets[0].config)) return 1;
+    }
+    bool result = true;
+    for (size_t t=0; t<CLEKS_ARR_LEN(gen_lexers) && result; ++t){
+        const ExampleTarget *target = example_find(gen_lexers[t].config);
+        result = target != NULL;
+        size_t token_count = 0;
+        for (size_t c=0; c<GEN_CORPORA && result; ++c){
+            ExampleCorpus corpus = {0};
+            result = example_fill(&corpus, target->config, GEN_CORPUS_SIZE, c);
+            // the corpus as it is first, then with every error blanked out
+            size_t offset = 0;
+            for (size_t r=0; r<GEN_REPAIRS && result && offset < corpus.len; ++r){
+                size_t count = gen_compare(corpus.data, corpus.len, target->config, gen_lexers[t].next, target->name, &offset);
+                result = count != SIZE_MAX;
+                token_count += result? count : 0;
+                example_blank(&corpus, target->config, offset);
+            }
+            free(corpus.data);
+        }
+        for (int f=0; f+1<argc && result; ++f){
+            size_t offset;
+            size_t count = gen_compare(files[f].buffer, files[f].buffer_size, target->config, gen_lexers[t].next, target->name, &offset);
+            result = count != SIZE_MAX;
+            token_count += result? count : 0;
+        }
+        if (result) printf("%-14s %zu tokens identical\n", target->name, token_count);
+    }
+    for (int i=1; i<argc; ++i) Cleks_destroy(&files[i-1]);
+    return result? 0 : 1;
+}
@@ -0,0 +1,101 @@
+/*
+    parallel_equiv.c
+    checks that Cleks_tokenize_parallel returns the same tokens as a single Clekser lexing the whole buffer
+
+    build: cc -O2 -pthread -o parallel_equiv tests/parallel_equiv.c
+    run:   ./parallel_equiv [file ...]
+
+    Every example config is tried with tracked and with lazy locations, on deterministic corpora of various sizes stitched
+    together from the config's own words, symbols, delimeters and number literals (including unterminated ones, which end
+    a chunk in the middle of a token) as well as on every given file, each split among 1 to 8 threads. As lexing stops at
+    the first error, every corpus is lexed again after blanking the fragment the error is in, until it lexes
+    without one, so both errors and clean joins end up in every chunk. The tokens, their locations, the error and the
+    return value have to match. Exits with 1 at the first difference, the errors of the lexers are reported on stderr.
+*/
+
+#define CLEKS_THREADS
+#include "../examples/examples.h"
+
+// the amount of corpora per config, the size of the largest one and the most threads a buffer is split among
+#define PARALLEL_CORPORA 16
+#define PARALLEL_CORPUS_SIZE (16*1024)
+#define PARALLEL_THREADS 8
+// the most times the error of a corpus is blanked out
+#define PARALLEL_REPAIRS 256
+
+// lex a buffer serially and with every amount of threads, returns the amount of tokens or SIZE_MAX if they differ
+// `offset` is set to where the error is, or to the buffer size if there is none
+static size_t parallel_compare(char *buffer, size_t buffer_size, const CleksConfig *config, const char *name, size_t *offset)
+{
+    Clekser clekser = Cleks_create(buffer, buffer_size, config, NULL);
+    clekser.silent = true;
+    CleksTokenBuffer reference = {0};
+    if (!Cleks_tokenize_all(&clekser, &reference)){
+        Cleks_destroy(&clekser);
+        return SIZE_MAX;
+    }
+    CleksError expected = clekser.error;
+    *offset = (expected.kind != CLEKS_ERROR_NONE)? expected.offset : buffer_size;
+    Cleks_destroy(&clekser);
+
+    bool same = true;
+    for (size_t threads=1; threads<=PARALLEL_THREADS && same; ++threads){
+        CleksTokenBuffer tokens = {0};
+        CleksError error = {0};
+        bool result = Cleks_tokenize_parallel(buffer, buffer_size, config, threads, &tokens, &error);
+        same = result == (expected.kind == CLEKS_ERROR_NONE) && tokens.count == reference.count
+            && error.kind == expected.kind && error.offset == expected.offset
+            && error.loc.row == expected.loc.row && error.loc.column == expected.loc.column;
+        size_t i = 0;
+        for (; i<reference.count && same; ++i){
+            same = tokens.ids[i] == reference.ids[i] && tokens.starts[i] == reference.starts[i] && tokens.lengths[i] == reference.lengths[i]
+                && tokens.rows[i] == reference.rows[i] && tokens.columns[i] == reference.columns[i];
+        }
+        if (!same){
+            printf("%s, flags 0x%02x, %zu threads: the tokens differ at token %zu of %zu (%zu lexed, errors %d and %d)\n",
+                name, config->flags, threads, (i > 0)? i-1 : 0, reference.count, tokens.count, expected.kind, error.kind);
+        }
+        Cleks_token_buffer_free(&tokens);
+    }
+    size_t count = reference.count;
+    Cleks_token_buffer_free(&reference);
+    return same? count : SIZE_MAX;
+}
+
+int main(int argc, char **argv)
+{
+    Clekser files[argc > 1? argc-1 : 1];
+    for (int i=1; i<argc; ++i){
+        if (!Cleks_create_from_file(&files[i-1], argv[i], example_targets[0].config)) return 1;
+    }
+    bool result = true;
+    for (size_t t=0; t<CLEKS_ARR_LEN(example_targets) && result; ++t){
+        size_t token_count = 0;
+        for (int lazy=0; lazy<2 && result; ++lazy){
+            CleksConfig config = *example_targets[t].config;
+            config.flags = lazy? config.flags | CLEKS_FLAGS_LAZY_LOC : config.flags & ~CLEKS_FLAGS_LAZY_LOC;
+            for (size_t c=0; c<PARALLEL_CORPORA && result; ++c){
+                // from a handful of bytes, which leaves most threads without a line of their own, up to the full size
+                ExampleCorpus corpus = {0};
+                result = example_fill(&corpus, &config, PARALLEL_CORPUS_SIZE >> (PARALLEL_CORPORA-1 - c)%12, c);
+                size_t offset = 0;
+                for (size_t r=0; r<PARALLEL_REPAIRS && result && offset < corpus.len; ++r){
+                    size_t count = parallel_compare(corpus.data, corpus.len, &config, example_targets[t].name, &offset);
+                    result = count != SIZE_MAX;
+                    token_count += result? count : 0;
+                    example_blank(&corpus, &config, offset);
+                }
+                free(corpus.data);
+            }
+            for (int f=0; f+1<argc && result; ++f){
+                size_t offset;
+                size_t count = parallel_compare(files[f].buffer, files[f].buffer_size, &config, example_targets[t].name, &offset);
+                result = count != SIZE_MAX;
+                token_count += result? count : 0;
+            }
+        }
+        if (result) printf("%-14s %zu tokens identical on 1 to %d threads\n", example_targets[t].name, token_count, PARALLEL_THREADS);
+    }
+    for (int i=1; i<argc; ++i) Cleks_destroy(&files[i-1]);
+    return result? 0 : 1;
+}
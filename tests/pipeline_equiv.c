@@ -0,0 +1,138 @@
+/*
+    pipeline_equiv.c
+    checks that a Clekser popping its tokens from a CleksPipeline returns the same tokens as one lexing on its own
+
+    build: cc -O1 -g -fsanitize=thread -pthread -o pipeline_equiv tests/pipeline_equiv.c
+    run:   ./pipeline_equiv
+
+    Every example config is tried with tracked and with lazy locations, on deterministic corpora stitched together from
+    the config's own words, symbols, delimeters and number literals. Each corpus is lexed as it is, stopping at its first
+    error, and after blanking out every error. Every run starts the pipeline after peeking a few tokens, with rings of
+    various sizes, and either pops every token or stops the pipeline early, after which the Clekser has to continue on
+    its own. At the end of the buffer or on an error, the Clekser has to end up where a serial one would: with the same
+    error, position and location, and returning the same once the pipeline is stopped. Meant to be run under
+    ThreadSanitizer, exits with 1 at the first difference.
+*/
+
+#define CLEKS_THREADS
+#include "../examples/examples.h"
+
+// the amount of corpora per config, the size of each one and the runs per corpus
+#define PIPELINE_CORPORA 4
+#define PIPELINE_CORPUS_SIZE (8*1024)
+#define PIPELINE_RUNS 16
+// the most times the error of a corpus is blanked out
+#define PIPELINE_REPAIRS 4096
+
+typedef struct{
+    CleksTokenBuffer tokens;
+    bool more;                  // what Cleks_next returns after the last token was followed by `false`
+    CleksError error;
+    size_t index;
+    CleksLoc loc;
+} PipelineReference;
+
+// lex a buffer serially, calling Cleks_next once more after it returned `false`
+static bool pipeline_reference(PipelineReference *reference, char *buffer, size_t buffer_size, const CleksConfig *config)
+{
+    Clekser clekser = Cleks_create(buffer, buffer_size, config, NULL);
+    clekser.silent = true;
+    memset(reference, 0, sizeof(*reference));
+    bool result = Cleks_tokenize_all(&clekser, &reference->tokens);
+    reference->error = clekser.error;
+    reference->index = clekser.index;
+    reference->loc = clekser.loc;
+    CleksToken token;
+    reference->more = Cleks_next(&clekser, &token);
+    Cleks_destroy(&clekser);
+    return result;
+}
+
+static bool pipeline_same_token(const PipelineReference *reference, size_t i, const char *buffer, CleksToken token)
+{
+    const CleksTokenBuffer *tokens = &reference->tokens;
+    return i < tokens->count && token.id == tokens->ids[i] && (size_t) (token.start - buffer) == tokens->starts[i]
+        && (size_t) (token.end - token.start) == tokens->lengths[i] && token.loc.row == tokens->rows[i] && token.loc.column == tokens->columns[i];
+}
+
+// lex a buffer through a pipeline, peeking `peeks` tokens first and stopping it after `stop_at` tokens, SIZE_MAX to never stop early
+static bool pipeline_run(const PipelineReference *reference, char *buffer, size_t buffer_size, const CleksConfig *config, size_t peeks, size_t capacity, size_t stop_at)
+{
+    Clekser clekser = Cleks_create(buffer, buffer_size, config, NULL);
+    clekser.silent = true;
+    CleksToken token;
+    for (size_t i=0; i<peeks && i<reference->tokens.count; ++i) Cleks_peek(&clekser, i, &token);
+    CleksPipeline pipeline;
+    bool same = Cleks_pipeline_start(&pipeline, &clekser, capacity);
+    bool piped = same;
+    size_t count = 0;
+    while (same){
+        if (piped && count == stop_at){
+            Cleks_pipeline_stop(&pipeline);
+            piped = false;
+        }
+        // peek now and then, which takes the tokens from the ring as well, but never past the last token like a parser would not
+        if (count % 7 == 3 && count + 1 < reference->tokens.count){
+            same = Cleks_peek(&clekser, 1, &token) && pipeline_same_token(reference, count + 1, buffer, token);
+        }
+        if (!same || !Cleks_next(&clekser, &token)) break;
+        same = pipeline_same_token(reference, count, buffer, token);
+        count++;
+    }
+    if (piped) Cleks_pipeline_stop(&pipeline);
+    // the clekser has to be where a serial one is, also after handing the end back from the pipeline
+    same = same && count == reference->tokens.count && clekser.error.kind == reference->error.kind
+        && clekser.error.offset == reference->error.offset && clekser.error.loc.row == reference->error.loc.row
+        && clekser.error.loc.column == reference->error.loc.column && clekser.index == reference->index
+        && clekser.loc.row == reference->loc.row && clekser.loc.column == reference->loc.column
+        && Cleks_next(&clekser, &token) == reference->more;
+    if (!same){
+        fprintf(stderr, "flags 0x%02x, %zu peeks, capacity %zu, stopped after %zu: the tokens differ after %zu of %zu tokens (errors %d and %d)\n",
+            config->flags, peeks, capacity, stop_at, count, reference->tokens.count, reference->error.kind, clekser.error.kind);
+    }
+    Cleks_destroy(&clekser);
+    return same;
+}
+
+int main(void)
+{
+    static const size_t capacities[] = {0, 1, 64, 200};
+    bool result = true;
+    uint64_t seed = 1;
+    for (size_t t=0; t<CLEKS_ARR_LEN(example_targets) && result; ++t){
+        size_t token_count = 0, runs = 0;
+        for (int lazy=0; lazy<2 && result; ++lazy){
+            CleksConfig config = *example_targets[t].config;
+            config.flags = lazy? config.flags | CLEKS_FLAGS_LAZY_LOC : config.flags & ~CLEKS_FLAGS_LAZY_LOC;
+            for (size_t c=0; c<PIPELINE_CORPORA*2 && result; ++c){
+                ExampleCorpus corpus = {0};
+                result = example_fill(&corpus, &config, PIPELINE_CORPUS_SIZE, c/2);
+                PipelineReference reference;
+                result = result && pipeline_reference(&reference, corpus.data, corpus.len, &config);
+                // the odd corpora are the even ones without their errors
+                for (size_t r=0; r<PIPELINE_REPAIRS && result && c%2 == 1 && reference.error.kind != CLEKS_ERROR_NONE; ++r){
+                    example_blank(&corpus, &config, reference.error.offset);
+                    Cleks_token_buffer_free(&reference.tokens);
+                    result = pipeline_reference(&reference, corpus.data, corpus.len, &config);
+                }
+                for (size_t r=0; r<PIPELINE_RUNS && result; ++r){
+                    ExampleCorpus random = {.seed = seed++};
+                    size_t peeks = example_random(&random, 3);
+                    size_t capacity = capacities[example_random(&random, CLEKS_ARR_LEN(capacities))];
+                    // stop before the first token, somewhere in between, after the last one or not at all
+                    size_t stop_at = SIZE_MAX;
+                    if (r%4 == 1) stop_at = 0;
+                    else if (r%4 == 2) stop_at = example_random(&random, (uint32_t) reference.tokens.count + 1);
+                    else if (r%4 == 3) stop_at = reference.tokens.count;
+                    result = pipeline_run(&reference, corpus.data, corpus.len, &config, peeks, capacity, stop_at);
+                    runs++;
+                }
+                token_count += reference.tokens.count;
+                Cleks_token_buffer_free(&reference.tokens);
+                free(corpus.data);
+            }
+        }
+        if (result) printf("%-14s %zu tokens identical in %zu pipelined runs\n", example_targets[t].name, token_count, runs);
+    }
+    return result? 0 : 1;
+}
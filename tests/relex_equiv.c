@@ -0,0 +1,120 @@
+/*
+    relex_equiv.c
+    checks that Cleks_relex updates a token buffer to the tokens of lexing the whole edited buffer again
+
+    build: cc -O2 -o relex_equiv tests/relex_equiv.c
+    run:   ./relex_equiv [edits]
+
+    Every example config is tried with tracked and with lazy locations, lexing with the lookup tables and with a
+    CleksDfa where the config has one. Each combination starts from a deterministic corpus stitched together from the
+    config's own words, symbols, delimeters and number literals, whose errors are blanked out, and applies random edits
+    to it: removing a few bytes, occasionally a whole stretch, and inserting another fragment of the config, which opens
+    and closes strings, comments and fields all over the buffer. As lexing stops at the first error, every other edit
+    after one blanks it out again. After every edit the tokens have to match those of Cleks_tokenize_all, 50000 edits
+    are spread over the combinations by default. Exits with 1 at the first difference.
+*/
+
+#include "../examples/examples.h"
+
+// the size of the corpus each combination starts from, the room it has to grow and the edits spread over the combinations
+#define RELEX_CORPUS_SIZE (2*1024)
+#define RELEX_CAPACITY (4*RELEX_CORPUS_SIZE)
+#define RELEX_EDITS 50000
+// the most times the errors of a starting corpus are blanked out
+#define RELEX_REPAIRS 4096
+
+// apply `edits` random edits to a corpus, relexing after each one, returns `false` at the first difference
+static bool relex_compare(ExampleCorpus *corpus, const CleksCompiledConfig *compiled, const CleksDfa *dfa, size_t edits, const char *name)
+{
+    // fragments are generated into their own corpus, whose generator picks the edits as well
+    char fragment[EXAMPLE_FRAGMENT_MAX];
+    ExampleCorpus random = {.data = fragment, .seed = corpus->seed};
+    Clekser clekser = Cleks_create_compiled(corpus->data, corpus->len, compiled, NULL);
+    if (dfa != NULL) Cleks_use_dfa(&clekser, dfa);
+    clekser.silent = true;
+    CleksTokenBuffer tokens = {0};
+    bool same = Cleks_tokenize_all(&clekser, &tokens);
+    CleksError error = clekser.error;
+    for (size_t e=0; e<edits && same; ++e){
+        CleksEdit edit;
+        if (error.kind != CLEKS_ERROR_NONE && example_random(&random, 2) == 0) edit = example_blank(corpus, &compiled->config, error.offset);
+        else{
+            edit = (CleksEdit) {.offset = example_random(&random, (uint32_t) corpus->len + 1)};
+            size_t tail = corpus->len - edit.offset;
+            // the corpus keeps around its starting size, large stretches are only removed from a larger one
+            bool stretch = corpus->len > RELEX_CORPUS_SIZE && example_random(&random, 16) == 0;
+            edit.removed = example_random(&random, stretch? 512 : 8);
+            if (edit.removed > tail) edit.removed = tail;
+            random.len = 0;
+            if (corpus->len < RELEX_CORPUS_SIZE || example_random(&random, 3) != 0) example_fragment(&random, &compiled->config);
+            if (corpus->len - edit.removed + random.len > RELEX_CAPACITY) random.len = 0;
+            edit.inserted = random.len;
+            memmove(corpus->data + edit.offset + edit.inserted, corpus->data + edit.offset + edit.removed, tail - edit.removed);
+            memcpy(corpus->data + edit.offset, fragment, edit.inserted);
+            corpus->len = corpus->len - edit.removed + edit.inserted;
+        }
+
+        clekser.buffer_size = corpus->len;
+        same = Cleks_relex(&clekser, &tokens, edit);
+        Clekser full = Cleks_create_compiled(corpus->data, corpus->len, compiled, NULL);
+        if (dfa != NULL) Cleks_use_dfa(&full, dfa);
+        full.silent = true;
+        CleksTokenBuffer reference = {0};
+        same = same && Cleks_tokenize_all(&full, &reference) && tokens.count == reference.count;
+        error = full.error;
+        size_t i = 0;
+        for (; i<reference.count && same; ++i){
+            same = tokens.ids[i] == reference.ids[i] && tokens.starts[i] == reference.starts[i] && tokens.lengths[i] == reference.lengths[i]
+                && tokens.rows[i] == reference.rows[i] && tokens.columns[i] == reference.columns[i];
+        }
+        if (!same){
+            fprintf(stderr, "%s, flags 0x%02x, %s: edit %zu (%zu bytes at %zu replaced by %zu) differs at token %zu of %zu (%zu relexed)\n",
+                name, compiled->config.flags, (dfa != NULL)? "automaton" : "tables", e, edit.removed, edit.offset, edit.inserted,
+                (i > 0)? i-1 : 0, reference.count, tokens.count);
+        }
+        Cleks_token_buffer_free(&reference);
+        Cleks_destroy(&full);
+    }
+    Cleks_token_buffer_free(&tokens);
+    Cleks_destroy(&clekser);
+    return same;
+}
+
+int main(int argc, char **argv)
+{
+    size_t edits = (argc > 1)? strtoull(argv[1], NULL, 10) : RELEX_EDITS;
+    size_t combinations = CLEKS_ARR_LEN(example_targets)*2*2;
+    bool result = true;
+    for (size_t t=0; t<CLEKS_ARR_LEN(example_targets) && result; ++t){
+        size_t relexed = 0;
+        for (size_t c=0; c<4 && result; ++c){
+            CleksConfig config = *example_targets[t].config;
+            config.flags = (c & 1)? config.flags | CLEKS_FLAGS_LAZY_LOC : config.flags & ~CLEKS_FLAGS_LAZY_LOC;
+            CleksCompiledConfig *compiled = Cleks_compile(&config);
+            CleksDfa *dfa = (compiled != NULL && (c & 2))? Cleks_compile_dfa(compiled) : NULL;
+            ExampleCorpus corpus = {0};
+            result = compiled != NULL && example_fill(&corpus, &config, RELEX_CORPUS_SIZE, c);
+            for (size_t r=0; r<RELEX_REPAIRS && result; ++r){
+                Clekser clekser = Cleks_create_compiled(corpus.data, corpus.len, compiled, NULL);
+                clekser.silent = true;
+                CleksToken token;
+                while (Cleks_next(&clekser, &token));
+                CleksError error = clekser.error;
+                Cleks_destroy(&clekser);
+                if (error.kind == CLEKS_ERROR_NONE) break;
+                example_blank(&corpus, &config, error.offset);
+            }
+            char *data = result? realloc(corpus.data, RELEX_CAPACITY) : NULL;
+            result = data != NULL;
+            corpus.data = result? data : corpus.data;
+            // a combination without an automaton still uses its share of the edits with the lookup tables
+            if (result) result = relex_compare(&corpus, compiled, dfa, edits/combinations, example_targets[t].name);
+            relexed += edits/combinations;
+            free(corpus.data);
+            Cleks_dfa_free(dfa);
+            Cleks_compiled_free(compiled);
+        }
+        if (result) printf("%-14s %zu edits relexed identically\n", example_targets[t].name, relexed);
+    }
+    return result? 0 : 1;
+}
@@ -0,0 +1,112 @@
+/*
+    thread_stress.c
+    lexes one buffer on many threads sharing a single CleksCompiledConfig and CleksDfa
+
+    build: cc -O1 -g -fsanitize=thread -pthread -o thread_stress tests/thread_stress.c
+    run:   ./thread_stress
+
+    Every thread gets its own references to the shared tables, and the creator drops its references while the threads
+    are still lexing, so the last thread to finish frees them. The threads also take and drop references of their own
+    between rounds. Each round lexes the buffer with either the lookup tables or the automaton and has to return the
+    tokens a single thread lexed beforehand. Meant to be run under ThreadSanitizer or AddressSanitizer, exits with 1 at
+    the first difference.
+*/
+
+#include "../examples/json_lexer.h"
+#include <pthread.h>
+
+// the amount of threads, the rounds each of them lexes and the size of the buffer
+#define STRESS_THREADS 16
+#define STRESS_ROUNDS 8
+#define STRESS_BUFFER_SIZE (64*1024)
+
+typedef struct{
+    char *buffer;
+    size_t buffer_size;
+    const CleksTokenBuffer *reference;
+    const CleksCompiledConfig *compiled;
+    const CleksDfa *dfa;
+    size_t id;
+    bool failed;
+} StressJob;
+
+// a json document, with a few number, string and word tokens in every entry
+static size_t stress_buffer(char *buffer, size_t size)
+{
+    size_t len = 0;
+    len += snprintf(buffer, size, "[\n");
+    for (unsigned i=0; len + 128 < size; ++i){
+        len += snprintf(buffer + len, size - len, "    {\"key%u\": [%u, -%u.5e3, \"str\\n%u\", true, null, false]},\n", i, i, i%97, i*7);
+    }
+    len += snprintf(buffer + len, size - len, "    {}\n]\n");
+    return len;
+}
+
+static void* stress_worker(void *arg)
+{
+    StressJob *job = arg;
+    for (size_t round=0; round<STRESS_ROUNDS && !job->failed; ++round){
+        // an extra owner for the round, which has to leave the tables alive for everyone else
+        const CleksCompiledConfig *compiled = Cleks_compiled_retain(job->compiled);
+        const CleksDfa *dfa = Cleks_dfa_retain(job->dfa);
+        Clekser clekser = Cleks_create_compiled(job->buffer, job->buffer_size, compiled, NULL);
+        if ((job->id + round) % 2 == 1) Cleks_use_dfa(&clekser, dfa);
+        const CleksTokenBuffer *reference = job->reference;
+        CleksToken token;
+        size_t count = 0;
+        while (!job->failed && Cleks_next(&clekser, &token)){
+            job->failed = count == reference->count || token.id != reference->ids[count]
+                || (size_t) (token.start - job->buffer) != reference->starts[count]
+                || token.loc.row != reference->rows[count] || token.loc.column != reference->columns[count];
+            count++;
+        }
+        if (!job->failed) job->failed = count != reference->count || clekser.error.kind != CLEKS_ERROR_NONE;
+        if (job->failed) fprintf(stderr, "thread %zu, round %zu: the tokens differ after %zu tokens\n", job->id, round, count);
+        Cleks_destroy(&clekser);
+        Cleks_dfa_free(dfa);
+        Cleks_compiled_free(compiled);
+    }
+    Cleks_dfa_free(job->dfa);
+    Cleks_compiled_free(job->compiled);
+    return NULL;
+}
+
+int main(void)
+{
+    char *buffer = malloc(STRESS_BUFFER_SIZE);
+    if (buffer == NULL) return 1;
+    size_t buffer_size = stress_buffer(buffer, STRESS_BUFFER_SIZE);
+    CleksCompiledConfig *compiled = Cleks_compile(&JsonConfig);
+    CleksDfa *dfa = (compiled != NULL)? Cleks_compile_dfa(compiled) : NULL;
+    if (dfa == NULL) return 1;
+
+    CleksTokenBuffer reference = {0};
+    Clekser clekser = Cleks_create_compiled(buffer, buffer_size, compiled, NULL);
+    bool result = Cleks_tokenize_all(&clekser, &reference) && clekser.error.kind == CLEKS_ERROR_NONE;
+    Cleks_destroy(&clekser);
+    if (!result) return 1;
+
+    StressJob jobs[STRESS_THREADS];
+    pthread_t threads[STRESS_THREADS];
+    size_t started = 0;
+    for (; started<STRESS_THREADS; ++started){
+        jobs[started] = (StressJob) {buffer, buffer_size, &reference, Cleks_compiled_retain(compiled), Cleks_dfa_retain(dfa), started, false};
+        if (pthread_create(&threads[started], NULL, stress_worker, &jobs[started]) != 0){
+            Cleks_dfa_free(jobs[started].dfa);
+            Cleks_compiled_free(jobs[started].compiled);
+            result = false;
+            break;
+        }
+    }
+    // the threads are the only owners from here on
+    Cleks_dfa_free(dfa);
+    Cleks_compiled_free(compiled);
+    for (size_t i=0; i<started; ++i){
+        pthread_join(threads[i], NULL);
+        result = result && !jobs[i].failed;
+    }
+    if (result) printf("%d threads lexed %zu tokens %d times each\n", STRESS_THREADS, reference.count, STRESS_ROUNDS);
+    Cleks_token_buffer_free(&reference);
+    free(buffer);
+    return result? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/*
+    cleks_dump.c
+    dumps the tokens of files lexed with one of the example configs
+
+    build: cc -O2 -o cleks_dump tools/cleks_dump.c
+    run:   ./cleks_dump [-f text|tsv|jsonl] [-o output] <config> <file ...>
+
+    The tokens of all files are written to `output` (default stdout) through a CleksWriter, in the lines of Cleks_print_default (text),
+    as tab separated values below a header line (tsv) or as one JSON object per token (jsonl).
+    Exits with 1 if a file could not be lexed completely or the output could not be written.
+*/
+
+#include "../examples/examples.h"
+
+// the amount of tokens lexed at once
+#define DUMP_BATCH 4096
+
+static bool dump_file(CleksWriter *writer, const CleksCompiledConfig *compiled, char *path, CleksTokenBuffer *tokens)
+{
+    Clekser clekser;
+    if (!Cleks_create_from_file(&clekser, path, &compiled->config)) return false;
+    clekser.compiled = compiled;
+    bool written = true;
+    size_t count;
+    do{
+        tokens->count = 0;
+        count = Cleks_tokenize_batch(&clekser, tokens, DUMP_BATCH);
+        for (size_t i=0; i<count && written; ++i) written = Cleks_write_token(writer, &clekser, Cleks_token_at(&clekser, tokens, i));
+    } while (count == DUMP_BATCH && written);
+    bool lexed = clekser.error.kind == CLEKS_ERROR_NONE;
+    Cleks_destroy(&clekser);
+    return lexed && written;
+}
+
+int main(int argc, char **argv)
+{
+    const char *formats[] = {
+        [CLEKS_FORMAT_TEXT] = "text",
+        [CLEKS_FORMAT_TSV] = "tsv",
+        [CLEKS_FORMAT_JSONL] = "jsonl",
+    };
+    CleksFormat format = CLEKS_FORMAT_TEXT;
+    const char *output = NULL;
+    const ExampleTarget *target = NULL;
+    int first_file = argc;
+    bool usage = false;
+    for (int i=1; i<argc && !usage; ++i){
+        if (strcmp(argv[i], "-f") == 0 && i+1 < argc){
+            usage = true;
+            for (size_t f=0; f<CLEKS_ARR_LEN(formats); ++f){
+                if (strcmp(argv[i+1], formats[f]) == 0){
+                    format = f;
+                    usage = false;
+                }
+            }
+            i++;
+        }
+        else if (strcmp(argv[i], "-o") == 0 && i+1 < argc) output = argv[++i];
+        else if (argv[i][0] != '-'){
+            target = example_find(argv[i]);
+            first_file = i+1;
+            break;
+        }
+        else usage = true;
+    }
+    if (usage || target == NULL || first_file >= argc){
+        fprintf(stderr, "usage: %s [-f text|tsv|jsonl] [-o output] <config> <file ...>\n", argv[0]);
+        example_list(stderr, "configs:");
+        return 1;
+    }
+    int fd = STDOUT_FILENO;
+    if (output != NULL && (fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0){
+        cleks_error("Could not open \"%s\" for writing: %s", output, strerror(errno));
+        return 1;
+    }
+    CleksCompiledConfig *compiled = Cleks_compile(target->config);
+    CleksWriter writer;
+    CleksTokenBuffer tokens = {0};
+    bool result = compiled != NULL && Cleks_writer_create(&writer, fd, format, 0);
+    if (result){
+        for (int i=first_file; i<argc; ++i) result &= dump_file(&writer, compiled, argv[i], &tokens);
+        result &= Cleks_writer_destroy(&writer);
+    }
+    Cleks_token_buffer_free(&tokens);
+    Cleks_compiled_free(compiled);
+    if (output != NULL) result &= close(fd) == 0;
+    return result? 0 : 1;
+}
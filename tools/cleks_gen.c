@@ -0,0 +1,50 @@
+/*
+    cleks_gen.c
+    writes a lexer specialized for one of the example configs
+
+    build: cc -O2 -o cleks_gen tools/cleks_gen.c
+    run:   ./cleks_gen [-o dir] [-i include] <config> <name>
+
+    Writes <dir>/<name>.h and <dir>/<name>.c, declaring `bool <name>_next(Clekser *clekser, CleksToken *token)`.
+    The generated source includes cleks2.h as `include` (default "cleks2.h"), CLEKS_IMPLEMENTATION has to be defined in one translation unit of the program.
+    To generate a lexer for your own config, include tools/cleks_gen.h with CLEKS_GEN_IMPLEMENTATION and call Cleks_generate.
+*/
+
+#include "../examples/examples.h"
+#define CLEKS_GEN_IMPLEMENTATION
+#include "cleks_gen.h"
+
+static FILE* gen_open(const char *dir, const char *name, const char *extension)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s.%s", dir, name, extension);
+    FILE *file = fopen(path, "w");
+    if (file == NULL) cleks_error("Could not open \"%s\" for writing", path);
+    return file;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = ".";
+    const char *include = "cleks2.h";
+    const char *args[2];
+    size_t arg_count = 0;
+    for (int i=1; i<argc; ++i){
+        if (strcmp(argv[i], "-o") == 0 && i+1 < argc) dir = argv[++i];
+        else if (strcmp(argv[i], "-i") == 0 && i+1 < argc) include = argv[++i];
+        else if (arg_count < CLEKS_ARR_LEN(args) && argv[i][0] != '-') args[arg_count++] = argv[i];
+        else arg_count = CLEKS_ARR_LEN(args) + 1;
+    }
+    const ExampleTarget *target = (arg_count == CLEKS_ARR_LEN(args))? example_find(args[0]) : NULL;
+    if (target == NULL){
+        fprintf(stderr, "usage: %s [-o dir] [-i include] <config> <name>\n", argv[0]);
+        example_list(stderr, "configs:");
+        return 1;
+    }
+    FILE *header = gen_open(dir, args[1], "h");
+    FILE *source = gen_open(dir, args[1], "c");
+    bool result = header != NULL && source != NULL && Cleks_generate(target->config, args[1], include, header, source);
+    if (header != NULL) result &= fclose(header) == 0;
+    if (source != NULL) result &= fclose(source) == 0;
+    return result? 0 : 1;
+}
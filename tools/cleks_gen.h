@@ -0,0 +1,511 @@
+/*
+    cleks_gen.h
+    generates C source of a lexer specialized for a single CleksConfig
+
+    The generated `<name>_next` dispatches on the first byte of every token with a switch,
+    compares words and delimeters against inlined literals and produces the same tokens as Cleks_next.
+    Include this file with CLEKS_GEN_IMPLEMENTATION defined in the program running the generator.
+*/
+
+#ifndef _CLEKS_GEN_H
+#define _CLEKS_GEN_H
+
+#include "../cleks2.h"
+
+// write a lexer for `config` as `<name>.h` to `header` and `<name>.c` to `source`, `include` is how both include cleks2.h
+bool Cleks_generate(const CleksConfig *config, const char *name, const char *include, FILE *header, FILE *source);
+
+#endif // _CLEKS_GEN_H
+
+#if defined(CLEKS_GEN_IMPLEMENTATION) && !defined(_CLEKS_GEN_C)
+#define _CLEKS_GEN_C
+
+// write `text`, replacing every '$' with the name of the lexer
+static void cleks_gen__emit(FILE *out, const char *name, const char *text)
+{
+    for (; *text; ++text){
+        if (*text == '$') fputs(name, out);
+        else fputc(*text, out);
+    }
+}
+
+// write a string as a C string literal
+static void cleks_gen__literal(FILE *out, const char *str, size_t len)
+{
+    fputc('"', out);
+    for (size_t i=0; i<len; ++i){
+        uint8_t c = (uint8_t) str[i];
+        if (c == '"' || c == '\\') fprintf(out, "\\%c", c);
+        else if (c >= 0x20 && c < 0x7f && c != '?') fputc(c, out);
+        // octal escapes never absorb the following characters
+        else fprintf(out, "\\%03o", c);
+    }
+    fputc('"', out);
+}
+
+static void cleks_gen__case(FILE *out, const char *indent, uint8_t c)
+{
+    if (c >= 0x20 && c < 0x7f && c != '\\' && c != '\'') fprintf(out, "%scase 0x%02x: // '%c'\n", indent, c, c);
+    else fprintf(out, "%scase 0x%02x:\n", indent, c);
+}
+
+// the delimeters of comments or fields, in the order they have to be tried in
+static size_t cleks_gen__prefix_order(const char **prefixes, size_t count, bool longest, size_t *order)
+{
+    for (size_t i=0; i<count; ++i) order[i] = i;
+    if (!longest) return count;
+    // stable insertion sort by descending length, so the first defined of equally long prefixes wins
+    for (size_t i=1; i<count; ++i){
+        size_t current = order[i];
+        size_t j = i;
+        for (; j > 0 && strlen(prefixes[order[j-1]]) < strlen(prefixes[current]); --j) order[j] = order[j-1];
+        order[j] = current;
+    }
+    return count;
+}
+
+// a function finding the first (or longest) of `prefixes` at the current position
+static void cleks_gen__match_function(FILE *out, const char *name, const char *kind, const char **prefixes, size_t count, bool longest)
+{
+    fprintf(out, "// the %s starting at the current position, CLEKS__NO_MATCH if there is none\n", kind);
+    fprintf(out, "static inline CleksTokenIndex %s__match_%s(const Clekser *clekser)\n{\n", name, kind);
+    if (count == 0){
+        fprintf(out, "    (void) clekser;\n    return CLEKS__NO_MATCH;\n}\n\n");
+        return;
+    }
+    fprintf(out, "    const char *p = clekser->buffer + clekser->index;\n");
+    fprintf(out, "    size_t left = clekser->buffer_size - clekser->index;\n");
+    fprintf(out, "    if (left == 0) return CLEKS__NO_MATCH;\n");
+    fprintf(out, "    switch ((uint8_t) *p){\n");
+    size_t *order = malloc(count * sizeof(*order));
+    cleks_gen__prefix_order(prefixes, count, longest, order);
+    bool done[256] = {0};
+    for (size_t i=0; i<count; ++i){
+        uint8_t first = (uint8_t) prefixes[order[i]][0];
+        if (done[first]) continue;
+        done[first] = true;
+        cleks_gen__case(out, "        ", first);
+        for (size_t j=i; j<count; ++j){
+            const char *prefix = prefixes[order[j]];
+            if ((uint8_t) prefix[0] != first) continue;
+            size_t len = strlen(prefix);
+            if (len == 1) fprintf(out, "            return %zu;\n", order[j]);
+            else{
+                fprintf(out, "            if (left >= %zu && memcmp(p, ", len);
+                cleks_gen__literal(out, prefix, len);
+                fprintf(out, ", %zu) == 0) return %zu;\n", len, order[j]);
+            }
+            if (len == 1) break;
+        }
+        fprintf(out, "            break;\n");
+    }
+    fprintf(out, "    }\n    return CLEKS__NO_MATCH;\n}\n\n");
+    free(order);
+}
+
+static const char *cleks_gen__helpers =
+"// move past the current byte\n"
+"static inline void $__consume(Clekser *clekser)\n"
+"{\n"
+"#if ($__FLAGS & CLEKS_FLAGS_LAZY_LOC) == 0\n"
+"    if (clekser->buffer[clekser->index] == '\\n'){\n"
+"        clekser->loc.row++;\n"
+"        clekser->loc.column = 1;\n"
+"    }\n"
+"    else clekser->loc.column++;\n"
+"#endif\n"
+"    clekser->index++;\n"
+"}\n"
+"\n"
+"static inline void $__skip(Clekser *clekser, size_t len)\n"
+"{\n"
+"    for (size_t i=0; i<len && clekser->index < clekser->buffer_size; ++i) $__consume(clekser);\n"
+"}\n"
+"\n"
+"static inline bool $__starts_with(const Clekser *clekser, const char *str, size_t len)\n"
+"{\n"
+"    return clekser->buffer_size - clekser->index >= len && memcmp(clekser->buffer + clekser->index, str, len) == 0;\n"
+"}\n"
+"\n"
+"// record an error like Cleks_next does\n"
+"static inline void $__error(Clekser *clekser, CleksErrorKind kind, CleksLoc loc, const char *p)\n"
+"{\n"
+"#if $__FLAGS & CLEKS_FLAGS_LAZY_LOC\n"
+"    loc = Cleks_loc_of(clekser, p - clekser->buffer);\n"
+"#endif\n"
+"    clekser->error = (CleksError) {.kind=kind, .loc=loc, .offset=p - clekser->buffer};\n"
+"}\n"
+"\n"
+"static inline void $__set_token(CleksToken *token, uint32_t type, uint32_t index, CleksLoc loc, char *start, char *end)\n"
+"{\n"
+"    token->id = cleks_token_id(type, index);\n"
+"    token->loc = loc;\n"
+"    token->start = start;\n"
+"    token->end = end;\n"
+"    token->symbol = CLEKS_NO_SYMBOL;\n"
+"}\n"
+"\n";
+
+static const char *cleks_gen__comments =
+"// skip a comment at the current position, returns `false` if it is not terminated\n"
+"static bool $__skip_comment(Clekser *clekser, bool *found)\n"
+"{\n"
+"    CleksTokenIndex index = $__match_comment(clekser);\n"
+"    if (index == CLEKS__NO_MATCH) return true;\n"
+"    CleksLoc loc = clekser->loc;\n"
+"    char *p_start = clekser->buffer + clekser->index;\n"
+"    $__skip(clekser, $__comment_start_lens[index]);\n"
+"    const char *end = $__comment_end[index];\n"
+"    size_t end_len = $__comment_end_lens[index];\n"
+"    while (!$__starts_with(clekser, end, end_len)){\n"
+"        if (clekser->index >= clekser->buffer_size){\n"
+"            $__error(clekser, CLEKS_ERROR_UNTERMINATED_COMMENT, loc, p_start);\n"
+"            if (!clekser->silent) cleks_error(\"Expected \\\"%s\\\" for matching comment delimeter \\\"%s\\\" at %s:%zu:%zu!\", end, $__comment_start[index], CLEKS_LOC_EXPAND(clekser->error.loc));\n"
+"            return false;\n"
+"        }\n"
+"        $__consume(clekser);\n"
+"        while (clekser->index < clekser->buffer_size && clekser->buffer[clekser->index] != end[0]) $__consume(clekser);\n"
+"    }\n"
+"    $__skip(clekser, end_len);\n"
+"    *found = true;\n"
+"    return true;\n"
+"}\n"
+"\n";
+
+static const char *cleks_gen__no_comments =
+"static inline bool $__skip_comment(Clekser *clekser, bool *found)\n"
+"{\n"
+"    (void) clekser;\n"
+"    (void) found;\n"
+"    return true;\n"
+"}\n"
+"\n";
+
+static const char *cleks_gen__find_end =
+"// move to the next `del` outside of comments, returns `false` if there is none\n"
+"static bool $__find_end(Clekser *clekser, const char *del, size_t len)\n"
+"{\n"
+"    if (len == 0) return true;\n"
+"    while (!$__starts_with(clekser, del, len)){\n"
+"        if (clekser->index >= clekser->buffer_size) return false;\n"
+"        bool found = false;\n"
+"        if (!$__skip_comment(clekser, &found)) return false;\n"
+"        if (found) continue;\n"
+"        $__consume(clekser);\n"
+"        // only the first byte of the delimeter or of a comment can stop the search\n"
+"        while (clekser->index < clekser->buffer_size){\n"
+"            uint8_t c = (uint8_t) clekser->buffer[clekser->index];\n"
+"            if (c == (uint8_t) del[0] || $__comment_first[c]) break;\n"
+"            $__consume(clekser);\n"
+"        }\n"
+"    }\n"
+"    return true;\n"
+"}\n"
+"\n";
+
+// a copy of Cleks__scan_number, as the generated code cannot rely on private functions
+static const char *cleks_gen__numbers =
+"static bool $__scan_special_float(const char *s, const char *e)\n"
+"{\n"
+"    static const char *names[] = {\"inf\", \"infinity\", \"nan\"};\n"
+"    for (size_t i=0; i<CLEKS_ARR_LEN(names); ++i){\n"
+"        size_t len = strlen(names[i]);\n"
+"        if ((size_t) (e - s) < len) continue;\n"
+"        size_t j = 0;\n"
+"        while (j < len && (s[j] | 0x20) == names[i][j]) j++;\n"
+"        if (j < len) continue;\n"
+"        if (s + len == e) return true;\n"
+"        if (i != 2 || s[len] != '(' || e[-1] != ')') continue;\n"
+"        for (const char *c = s + len + 1; c < e - 1; ++c){\n"
+"            // ASCII only, like the lexer, so the locale does not matter\n"
+"            bool alnum = (uint8_t) (*c - '0') < 10 || (uint8_t) ((*c | 0x20) - 'a') < 26;\n"
+"            if (!alnum && *c != '_') return false;\n"
+"        }\n"
+"        return true;\n"
+"    }\n"
+"    return false;\n"
+"}\n"
+"\n"
+"static CleksTokenType $__scan_number(const char *s, const char *e)\n"
+"{\n"
+"    if (e - s > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'b')){\n"
+"        bool hex = s[1] == 'x';\n"
+"        for (s += 2; s < e; ++s){\n"
+"            uint8_t c = (uint8_t) *s;\n"
+"            bool digit = hex? ((uint8_t) (c - '0') < 10 || (uint8_t) ((c | 0x20) - 'a') < 6) : (c == '0' || c == '1');\n"
+"            if (!digit) return CLEKS_UNKNOWN;\n"
+"        }\n"
+"        return hex? CLEKS_HEX : CLEKS_BIN;\n"
+"    }\n"
+"    if (s < e && (*s == '+' || *s == '-')) s++;\n"
+"    const char *digits = s;\n"
+"    while (s < e && (uint8_t) (*s - '0') < 10) s++;\n"
+"    bool integral = s > digits;\n"
+"    if (s == e) return integral? CLEKS_INTEGER : CLEKS_UNKNOWN;\n"
+"    if (*s == '.'){\n"
+"        const char *fraction = ++s;\n"
+"        while (s < e && (uint8_t) (*s - '0') < 10) s++;\n"
+"        if (!integral && s == fraction) return CLEKS_UNKNOWN;\n"
+"    }\n"
+"    else if (!integral) return $__scan_special_float(s, e)? CLEKS_FLOAT : CLEKS_UNKNOWN;\n"
+"    if (s < e && (*s | 0x20) == 'e'){\n"
+"        if (++s < e && (*s == '+' || *s == '-')) s++;\n"
+"        const char *exponent = s;\n"
+"        while (s < e && (uint8_t) (*s - '0') < 10) s++;\n"
+"        if (s == exponent) return CLEKS_UNKNOWN;\n"
+"    }\n"
+"    return (s == e)? CLEKS_FLOAT : CLEKS_UNKNOWN;\n"
+"}\n"
+"\n";
+
+static const char *cleks_gen__classify =
+"    char *p_end = clekser->buffer + clekser->index;\n"
+"    CleksTokenIndex index = $__match_word(p, p_end - p);\n"
+"    if (index != CLEKS__NO_MATCH){\n"
+"        $__set_token(token, CLEKS_WORD, index, loc, p, p_end);\n"
+"        return true;\n"
+"    }\n"
+"#if $__FLAGS & CLEKS_FLAGS_ALL_NUMS\n"
+"    CleksTokenType type = $__scan_number(p, p_end);\n"
+"    if (type == CLEKS_INTEGER && ($__FLAGS & CLEKS_FLAGS_INTEGERS) == 0) type = CLEKS_FLOAT;\n"
+"    if ((type == CLEKS_INTEGER && ($__FLAGS & CLEKS_FLAGS_INTEGERS)) || (type == CLEKS_FLOAT && ($__FLAGS & CLEKS_FLAGS_FLOATS))\n"
+"        || (type == CLEKS_HEX && ($__FLAGS & CLEKS_FLAGS_HEX)) || (type == CLEKS_BIN && ($__FLAGS & CLEKS_FLAGS_BIN))){\n"
+"        $__set_token(token, type, 0, loc, p, p_end);\n"
+"        return true;\n"
+"    }\n"
+"#endif\n"
+"#if ($__FLAGS & CLEKS_FLAGS_DISABLE_UNKNOWN) == 0\n"
+"    $__set_token(token, CLEKS_UNKNOWN, ($__FLAGS & CLEKS_FLAGS_KEEP_UNKNOWN)? 1:0, loc, p, p_end);\n"
+"    return true;\n"
+"#else\n"
+"    $__error(clekser, CLEKS_ERROR_UNKNOWN_WORD, loc, p);\n"
+"    if (!clekser->silent) cleks_error(\"Unknown word found (flags: %d) at %s:%zu:%zu \\\"%.*s\\\"\", $__FLAGS, CLEKS_LOC_EXPAND(clekser->error.loc), (int) (p_end - p), p);\n"
+"    return false;\n"
+"#endif\n"
+"}\n";
+
+// a function looking up a word by its length and first byte
+static void cleks_gen__words(FILE *out, const char *name, const CleksConfig *config)
+{
+    fprintf(out, "static CleksTokenIndex %s__match_word(const char *s, size_t len)\n{\n", name);
+    size_t max_len = 0;
+    for (size_t i=0; i<config->word_count; ++i) if (strlen(config->words[i]) > max_len) max_len = strlen(config->words[i]);
+    if (config->word_count > 0) fprintf(out, "    switch (len){\n");
+    for (size_t len=0; config->word_count > 0 && len<=max_len; ++len){
+        size_t count = 0;
+        for (size_t i=0; i<config->word_count; ++i) count += strlen(config->words[i]) == len;
+        if (count == 0) continue;
+        fprintf(out, "        case %zu:\n", len);
+        // many words of the same length are told apart by their first byte first
+        bool by_byte = len > 0 && count > 4;
+        if (by_byte) fprintf(out, "            switch ((uint8_t) s[0]){\n");
+        bool done[256] = {0};
+        for (size_t i=0; i<config->word_count; ++i){
+            if (strlen(config->words[i]) != len) continue;
+            uint8_t first = (uint8_t) config->words[i][0];
+            if (by_byte){
+                if (done[first]) continue;
+                done[first] = true;
+                cleks_gen__case(out, "                ", first);
+            }
+            for (size_t j=i; j<config->word_count; ++j){
+                if (strlen(config->words[j]) != len || (by_byte && (uint8_t) config->words[j][0] != first)) continue;
+                // later duplicates can never match
+                bool duplicate = false;
+                for (size_t k=0; k<j && !duplicate; ++k) duplicate = strcmp(config->words[k], config->words[j]) == 0;
+                if (duplicate) continue;
+                fprintf(out, "%s            if (memcmp(s, ", by_byte? "        " : "");
+                cleks_gen__literal(out, config->words[j], len);
+                fprintf(out, ", %zu) == 0) return %zu;\n", len, j);
+            }
+            if (by_byte) fprintf(out, "                    break;\n");
+            else break;
+        }
+        if (by_byte) fprintf(out, "            }\n");
+        fprintf(out, "            break;\n");
+    }
+    if (config->word_count > 0) fprintf(out, "    }\n");
+    else fprintf(out, "    (void) s;\n    (void) len;\n");
+    fprintf(out, "    return CLEKS__NO_MATCH;\n}\n\n");
+}
+
+static void cleks_gen__string_array(FILE *out, const char *name, const char *array, const char **strings, size_t count)
+{
+    fprintf(out, "static const char *%s__%s[] = {", name, array);
+    for (size_t i=0; i<count; ++i){
+        fprintf(out, (i > 0)? ", " : "");
+        cleks_gen__literal(out, strings[i], strlen(strings[i]));
+    }
+    fprintf(out, "};\n");
+    fprintf(out, "static const size_t %s__%s_lens[] = {", name, array);
+    for (size_t i=0; i<count; ++i) fprintf(out, (i > 0)? ", %zu" : "%zu", strlen(strings[i]));
+    fprintf(out, "};\n");
+}
+
+bool Cleks_generate(const CleksConfig *config, const char *name, const char *include, FILE *header, FILE *source)
+{
+    cleks_assert(config != NULL && name != NULL && include != NULL && header != NULL && source != NULL, "Invalid arguments config:%p, name:%p, include:%p, header:%p, source:%p", config, name, include, header, source);
+    bool identifier = isalpha((uint8_t) name[0]) || name[0] == '_';
+    for (const char *c = name; *c; ++c) identifier &= isalnum((uint8_t) *c) || *c == '_';
+    if (!identifier){
+        cleks_error("The name of a generated lexer has to be a C identifier, got \"%s\"", name);
+        return false;
+    }
+    bool longest = config->flags & CLEKS_FLAGS_LONGEST_MATCH;
+    const char **comment_starts = malloc((config->comment_count + 1) * sizeof(char*));
+    const char **comment_ends = malloc((config->comment_count + 1) * sizeof(char*));
+    const char **field_prefixes = malloc((config->field_count + 1) * sizeof(char*));
+    const char **field_suffixes = malloc((config->field_count + 1) * sizeof(char*));
+    if (comment_starts == NULL || comment_ends == NULL || field_prefixes == NULL || field_suffixes == NULL){
+        cleks_error("Could not allocate the delimeter lists!");
+        free(comment_starts); free(comment_ends); free(field_prefixes); free(field_suffixes);
+        return false;
+    }
+    bool valid = true;
+    for (size_t i=0; i<config->comment_count; ++i){
+        comment_starts[i] = config->comments[i].start_del;
+        comment_ends[i] = config->comments[i].end_del;
+        valid &= comment_starts[i][0] != '\0';
+    }
+    for (size_t i=0; i<config->field_count; ++i){
+        field_prefixes[i] = config->fields[i].prefix;
+        field_suffixes[i] = config->fields[i].suffix;
+        valid &= field_prefixes[i][0] != '\0';
+    }
+    if (!valid){
+        cleks_error("Empty comment start delimeters and field prefixes cannot be generated");
+        free(comment_starts); free(comment_ends); free(field_prefixes); free(field_suffixes);
+        return false;
+    }
+
+    fprintf(header, "// %s.h, generated by cleks_gen, do not edit\n\n", name);
+    fprintf(header, "#ifndef _");
+    for (const char *c = name; *c; ++c) fputc(toupper((uint8_t) *c), header);
+    fprintf(header, "_H\n#define _");
+    for (const char *c = name; *c; ++c) fputc(toupper((uint8_t) *c), header);
+    fprintf(header, "_H\n\n#include \"%s\"\n\n", include);
+    fprintf(header, "// retreive the next token like Cleks_next, `clekser` only provides the buffer and the position\n");
+    fprintf(header, "bool %s_next(Clekser *clekser, CleksToken *token);\n\n#endif\n", name);
+
+    fprintf(source, "// %s.c, generated by cleks_gen, do not edit\n\n", name);
+    fprintf(source, "#include \"%s.h\"\n\n", name);
+    fprintf(source, "#define %s__FLAGS 0x%02x\n\n", name, config->flags);
+    cleks_gen__emit(source, name, cleks_gen__helpers);
+
+    // every byte of a whitespace, symbol or string start ends a word right away
+    bool space[256] = {0}, word_end[256] = {0}, prefix_first[256] = {0}, comment_first[256] = {0};
+    for (size_t i=0; i<config->whitespace_count; ++i) space[(uint8_t) config->whitespaces[i]] = word_end[(uint8_t) config->whitespaces[i]] = true;
+    for (size_t i=0; i<config->symbol_count; ++i) word_end[(uint8_t) config->symbols[i]] = true;
+    for (size_t i=0; i<config->string_count; ++i) word_end[(uint8_t) config->strings[i].start_del] = true;
+    for (size_t i=0; i<config->comment_count; ++i) comment_first[(uint8_t) comment_starts[i][0]] = prefix_first[(uint8_t) comment_starts[i][0]] = true;
+    for (size_t i=0; i<config->field_count; ++i) prefix_first[(uint8_t) field_prefixes[i][0]] = true;
+
+    fprintf(source, "static inline bool %s__is_space(char c)\n{\n    switch ((uint8_t) c){\n", name);
+    for (size_t c=0; c<256; ++c) if (space[c]) cleks_gen__case(source, "        ", c);
+    fprintf(source, "%s", (config->whitespace_count > 0)? "            return true;\n" : "");
+    fprintf(source, "        default: return cleks__is_special(c);\n    }\n}\n\n");
+
+    cleks_gen__match_function(source, name, "comment", comment_starts, config->comment_count, longest);
+    cleks_gen__match_function(source, name, "field", field_prefixes, config->field_count, longest);
+
+    fprintf(source, "static inline bool %s__is_word_end(const Clekser *clekser)\n{\n", name);
+    fprintf(source, "    char c = clekser->buffer[clekser->index];\n    switch ((uint8_t) c){\n");
+    bool any = false;
+    for (size_t c=0; c<256; ++c) if (word_end[c]){ cleks_gen__case(source, "        ", c); any = true; }
+    if (any) fprintf(source, "            return true;\n");
+    any = false;
+    for (size_t c=0; c<256; ++c) if (prefix_first[c] && !word_end[c]){ cleks_gen__case(source, "        ", c); any = true; }
+    if (any) fprintf(source, "            return cleks__is_special(c) || %s__match_comment(clekser) != CLEKS__NO_MATCH || %s__match_field(clekser) != CLEKS__NO_MATCH;\n", name, name);
+    fprintf(source, "        default: return cleks__is_special(c);\n    }\n}\n\n");
+
+    if (config->comment_count > 0){
+        cleks_gen__string_array(source, name, "comment_start", comment_starts, config->comment_count);
+        cleks_gen__string_array(source, name, "comment_end", comment_ends, config->comment_count);
+        fprintf(source, "\n");
+        cleks_gen__emit(source, name, cleks_gen__comments);
+    }
+    else cleks_gen__emit(source, name, cleks_gen__no_comments);
+    if (config->field_count > 0){
+        cleks_gen__string_array(source, name, "field_prefix", field_prefixes, config->field_count);
+        cleks_gen__string_array(source, name, "field_suffix", field_suffixes, config->field_count);
+        fprintf(source, "\n");
+    }
+    // only strings and fields search for an end delimeter
+    if (config->string_count > 0 || config->field_count > 0){
+        fprintf(source, "// the bytes a comment can start with\nstatic const bool %s__comment_first[256] = {", name);
+        for (size_t c=0; c<256; ++c) if (comment_first[c]) fprintf(source, "[0x%02zx] = true, ", c);
+        fprintf(source, "[0] = %s};\n\n", comment_first[0]? "true" : "false");
+        cleks_gen__emit(source, name, cleks_gen__find_end);
+    }
+    cleks_gen__words(source, name, config);
+    if (config->flags & CLEKS_FLAGS_ALL_NUMS) cleks_gen__emit(source, name, cleks_gen__numbers);
+
+    fprintf(source, "bool %s_next(Clekser *clekser, CleksToken *token)\n{\n", name);
+    cleks_gen__emit(source, name,
+        "    clekser->error.kind = CLEKS_ERROR_NONE;\n"
+        "    while (true){\n"
+        "        if (clekser->index >= clekser->buffer_size) return false;\n"
+        "        while (clekser->index < clekser->buffer_size && $__is_space(clekser->buffer[clekser->index])) $__consume(clekser);\n"
+        "        if (clekser->index >= clekser->buffer_size) return false;\n"
+        "        bool found = false;\n"
+        "        if (!$__skip_comment(clekser, &found)) return false;\n"
+        "        if (!found) break;\n"
+        "    }\n"
+        "    char *p = clekser->buffer + clekser->index;\n"
+        "    CleksLoc loc = clekser->loc;\n");
+    // strings take precedence over symbols, the first defined of either wins
+    bool dispatched[256] = {0};
+    bool cases = config->string_count > 0 || config->symbol_count > 0;
+    if (cases) fprintf(source, "    switch ((uint8_t) *p){\n");
+    for (size_t i=0; i<config->string_count; ++i){
+        CleksString string = config->strings[i];
+        if (dispatched[(uint8_t) string.start_del]) continue;
+        dispatched[(uint8_t) string.start_del] = true;
+        cleks_gen__case(source, "        ", string.start_del);
+        fprintf(source, "            %s__consume(clekser);\n", name);
+        fprintf(source, "            if (!%s__find_end(clekser, ", name);
+        cleks_gen__literal(source, &string.end_del, 1);
+        fprintf(source, ", 1)){\n");
+        fprintf(source, "                %s__error(clekser, CLEKS_ERROR_UNTERMINATED_STRING, loc, p);\n", name);
+        fprintf(source, "                if (!clekser->silent) cleks_error(\"Expected matching '%%c' after string delimeter '%%c' at %%s:%%zu:%%zu\", %d, %d, CLEKS_LOC_EXPAND(clekser->error.loc));\n", string.end_del, string.start_del);
+        fprintf(source, "                return false;\n            }\n");
+        fprintf(source, "            %s__set_token(token, CLEKS_STRING, %zu, loc, p+1, clekser->buffer + clekser->index);\n", name, i);
+        fprintf(source, "            %s__consume(clekser);\n            return true;\n", name);
+    }
+    for (size_t i=0; i<config->symbol_count; ++i){
+        uint8_t c = (uint8_t) config->symbols[i];
+        if (dispatched[c]) continue;
+        dispatched[c] = true;
+        cleks_gen__case(source, "        ", c);
+        fprintf(source, "            %s__set_token(token, CLEKS_SYMBOL, %zu, loc, p, p+1);\n", name, i);
+        fprintf(source, "            %s__consume(clekser);\n            return true;\n", name);
+    }
+    if (cases) fprintf(source, "    }\n");
+    if (config->field_count > 0){
+        cleks_gen__emit(source, name,
+            "    CleksTokenIndex field = $__match_field(clekser);\n"
+            "    if (field != CLEKS__NO_MATCH){\n"
+            "        $__skip(clekser, $__field_prefix_lens[field]);\n"
+            "        char *p_start = clekser->buffer + clekser->index;\n"
+            "        CleksLoc field_loc = clekser->loc;\n"
+            "        if (!$__find_end(clekser, $__field_suffix[field], $__field_suffix_lens[field])){\n"
+            "            $__error(clekser, CLEKS_ERROR_UNTERMINATED_FIELD, field_loc, p_start);\n"
+            "            if (!clekser->silent) cleks_error(\"Expected \\\"%s\\\" for matching field prefix \\\"%s\\\" at %s:%zu:%zu!\", $__field_suffix[field], $__field_prefix[field], CLEKS_LOC_EXPAND(clekser->error.loc));\n"
+            "            return false;\n"
+            "        }\n"
+            "        char *p_end = clekser->buffer + clekser->index;\n"
+            "        $__skip(clekser, $__field_suffix_lens[field]);\n"
+            "        $__set_token(token, CLEKS_FIELD, field, field_loc, p_start, p_end);\n"
+            "        return true;\n"
+            "    }\n");
+    }
+    cleks_gen__emit(source, name, "    while (clekser->index < clekser->buffer_size && !$__is_word_end(clekser)) $__consume(clekser);\n");
+    cleks_gen__emit(source, name, cleks_gen__classify);
+    free(comment_starts);
+    free(comment_ends);
+    free(field_prefixes);
+    free(field_suffixes);
+    return !ferror(header) && !ferror(source);
+}
+
+#endif // CLEKS_GEN_IMPLEMENTATION